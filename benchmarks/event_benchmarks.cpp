@@ -0,0 +1,167 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+// project
+#include "ddf/core/channels.hpp"
+#include "ddf/core/ddf.hpp"
+#include "ddf/core/payload.hpp"
+
+// external
+#include <benchmark/benchmark.h>
+
+// standard
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ltb::ddf::bench {
+namespace {
+
+constexpr auto events_per_tick = 64;
+
+/// \brief One event source firing a batch per tick into 'fan_out' sinks
+auto BM_EventFanOut(benchmark::State& state) -> void {
+    auto const fan_out = static_cast<std::size_t>(state.range(0));
+
+    ddf  graph;
+    auto events = graph.add_event_source<int>("events", [i = 0](EventBuffer<int>& out) mutable {
+        for (auto e = 0; e < events_per_tick; ++e) {
+            out.fire(++i);
+        }
+    });
+
+    auto total = 0L;
+    for (auto s = 0u; s < fan_out; ++s) {
+        graph.add_event_sink(
+            "sum",
+            [&total](Span<int const> batch) {
+                for (auto value : batch) {
+                    total += value;
+                }
+            },
+            events);
+    }
+
+    graph.compile().value_or_throw();
+
+    for (auto _ : state) {
+        graph.tick();
+    }
+
+    benchmark::DoNotOptimize(total);
+    state.SetItemsProcessed(state.iterations() * state.range(0) * events_per_tick);
+}
+
+constexpr auto payload_size = std::size_t{1u} << 16u;
+
+/// \brief A large buffer produced each tick and kept by 'fan_out' sinks
+template <typename Buffer, typename Make>
+auto large_value_fan_out(benchmark::State& state, Make make) -> void {
+    auto const fan_out = static_cast<std::size_t>(state.range(0));
+
+    ddf  graph;
+    auto cloud = graph.add_source("cloud", make);
+
+    // Each sink holds on to the latest buffer, e.g. to hand it to another thread
+    auto kept = std::vector<Buffer>(fan_out);
+    for (auto& keep : kept) {
+        graph.add_sink("keep", [&keep](Buffer const& buffer) { keep = buffer; }, cloud);
+    }
+
+    graph.compile().value_or_throw();
+
+    for (auto _ : state) {
+        graph.tick();
+    }
+
+    benchmark::DoNotOptimize(kept.data());
+    state.SetBytesProcessed(state.iterations() * state.range(0) * std::int64_t(payload_size * sizeof(float)));
+}
+
+auto BM_VectorFanOut(benchmark::State& state) -> void {
+    large_value_fan_out<std::vector<float>>(state, [] { return std::vector<float>(payload_size, 1.f); });
+}
+
+auto BM_PayloadFanOut(benchmark::State& state) -> void {
+    PayloadPool<float> pool;
+    large_value_fan_out<Payload<float>>(state, [&pool] {
+        auto buffer = pool.acquire(payload_size);
+        std::fill(buffer.data(), buffer.data() + buffer.size(), 1.f);
+        return std::move(buffer).freeze();
+    });
+}
+
+/// \brief Events pushed through an event channel by a producer region ticking on another thread
+auto BM_CrossRegionThroughput(benchmark::State& state) -> void {
+    ddf producer;
+    ddf consumer;
+
+    auto counter = producer.add_event_source<int>("counter", [i = 0](EventBuffer<int>& out) mutable {
+        for (auto e = 0; e < events_per_tick; ++e) {
+            out.fire(++i);
+        }
+    });
+
+    auto channel = add_event_channel(producer, counter, consumer, "events", static_cast<std::size_t>(state.range(0)));
+
+    auto received = std::int64_t{0};
+    consumer.add_event_sink(
+        "count", [&received](Span<int const> batch) { received += static_cast<std::int64_t>(batch.size()); },
+        channel.received);
+
+    producer.compile().value_or_throw();
+    consumer.compile().value_or_throw();
+
+    std::atomic_bool running{true};
+    std::thread      producer_thread([&] {
+        auto const capacity = channel.queue->capacity();
+
+        while (running.load(std::memory_order_relaxed)) {
+            // Back off instead of dropping so the benchmark measures delivered events
+            if (channel.queue->size() + events_per_tick > capacity) {
+                std::this_thread::yield();
+                continue;
+            }
+            producer.tick();
+        }
+    });
+
+    for (auto _ : state) {
+        consumer.tick();
+    }
+
+    running = false;
+    producer_thread.join();
+
+    state.SetItemsProcessed(received);
+    state.counters["dropped"] = static_cast<double>(channel.queue->dropped());
+}
+
+} // namespace
+
+BENCHMARK(BM_EventFanOut)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK(BM_VectorFanOut)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_PayloadFanOut)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_CrossRegionThroughput)->RangeMultiplier(8)->Range(1024, 65536)->UseRealTime();
+
+} // namespace ltb::ddf::bench
@@ -0,0 +1,205 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+// project
+#include "synthetic_graph.hpp"
+#include "ddf/core/graph_file.hpp"
+#include "ddf/core/parallel_executor.hpp"
+
+// external
+#include <benchmark/benchmark.h>
+
+// standard
+#include <sstream>
+
+namespace ltb::ddf::bench {
+namespace {
+
+/// \brief A single chain of transforms: each tick pulls the source value through 'depth' nodes
+auto state_pull_chain(benchmark::State& state, EvaluationMode mode) -> void {
+    auto const depth = static_cast<std::size_t>(state.range(0));
+
+    ddf  graph;
+    auto value = graph.add_source("source", [i = 0]() mutable { return ++i / 4; });
+
+    for (auto d = 0u; d < depth; ++d) {
+        value = graph.add_transform("increment", [](int x) { return x + 1; }, value);
+    }
+
+    graph.set_evaluation_mode(mode);
+    graph.compile().value_or_throw();
+
+    for (auto _ : state) {
+        graph.tick();
+        benchmark::DoNotOptimize(graph.value(value));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(depth + 1u));
+}
+
+auto BM_StatePullChain(benchmark::State& state) -> void {
+    state_pull_chain(state, EvaluationMode::Full);
+}
+
+/// \brief The source only changes every fourth tick so most ticks are cut off at the source
+auto BM_StatePullChainIncremental(benchmark::State& state) -> void {
+    state_pull_chain(state, EvaluationMode::Incremental);
+}
+
+/// \brief A chain ticked by a ParallelExecutor, with the chain fused into one task or scheduled node by node
+auto parallel_chain(benchmark::State& state, bool fuse_chains) -> void {
+    auto const depth = static_cast<std::size_t>(state.range(0));
+
+    ddf  graph;
+    auto value = graph.add_source("source", [i = 0]() mutable { return ++i; });
+
+    for (auto d = 0u; d < depth; ++d) {
+        value = graph.add_transform("increment", [](int x) { return x + 1; }, value);
+    }
+
+    graph.set_node_fusion(fuse_chains);
+    graph.compile().value_or_throw();
+
+    ParallelExecutor executor;
+
+    for (auto _ : state) {
+        graph.tick(executor);
+        benchmark::DoNotOptimize(graph.value(value));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(depth + 1u));
+}
+
+auto BM_ParallelChain(benchmark::State& state) -> void {
+    parallel_chain(state, false);
+}
+
+auto BM_ParallelChainFused(benchmark::State& state) -> void {
+    parallel_chain(state, true);
+}
+
+auto BM_GraphCompile(benchmark::State& state) -> void {
+    auto const node_count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto graph = make_layered_graph(node_count);
+        state.ResumeTiming();
+
+        graph.compile().value_or_throw();
+        benchmark::DoNotOptimize(graph.plan().steps().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// \brief Instantiates and compiles a serialized layered graph with the same shape as 'make_layered_graph'
+auto BM_GraphLoad(benchmark::State& state) -> void {
+    auto const node_count = static_cast<std::size_t>(state.range(0));
+    auto const width      = std::min(node_count, std::size_t{64u});
+
+    NodeTypeRegistry registry;
+    registry.add_type("source", Inputs<>{}, Outputs<int>{}, [] {
+        return [](NodeContext& ctx) { ctx.output<int>(0) = 1; };
+    });
+    registry.add_type("sum", Inputs<int, int>{}, Outputs<int>{}, [] {
+        return [](NodeContext& ctx) { ctx.output<int>(0) = ctx.input<int>(0) + ctx.input<int>(1); };
+    });
+
+    GraphDescription description;
+    auto             seed = std::uint32_t{12345u};
+
+    for (auto n = 0u; n < node_count; ++n) {
+        if (n < width) {
+            description.add_node("source", "source");
+            continue;
+        }
+
+        auto const layer_begin = static_cast<NodeId>((n / width - 1u) * width);
+        auto const node        = description.add_node("sum", "sum");
+
+        for (auto input = 0u; input < 2u; ++input) {
+            seed = seed * 1664525u + 1013904223u;
+            description.connect({layer_begin + (seed >> 8u) % static_cast<NodeId>(width), 0u}, {node, input});
+        }
+    }
+
+    std::stringstream stream;
+    write_graph(stream, description);
+    auto const data  = stream.str();
+    auto const bytes = Span<std::byte const>(reinterpret_cast<std::byte const*>(data.data()), data.size());
+
+    for (auto _ : state) {
+        auto graph = load_graph(bytes, registry);
+        benchmark::DoNotOptimize(graph->plan().steps().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(data.size()));
+}
+
+auto BM_TickLatency(benchmark::State& state) -> void {
+    auto graph = make_layered_graph(static_cast<std::size_t>(state.range(0)));
+    graph.compile().value_or_throw();
+
+    Histogram latency;
+
+    for (auto _ : state) {
+        auto const begin = Profiler::now();
+        graph.tick();
+        latency.record(Profiler::now() - begin);
+    }
+
+    report_percentiles(state, latency);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+auto BM_TickLatencyParallel(benchmark::State& state) -> void {
+    auto graph = make_layered_graph(static_cast<std::size_t>(state.range(0)));
+    graph.compile().value_or_throw();
+
+    ParallelExecutor executor;
+    Histogram        latency;
+
+    for (auto _ : state) {
+        auto const begin = Profiler::now();
+        graph.tick(executor);
+        latency.record(Profiler::now() - begin);
+    }
+
+    report_percentiles(state, latency);
+    state.counters["workers"] = static_cast<double>(executor.worker_count());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_StatePullChain)->RangeMultiplier(4)->Range(1, 4096);
+BENCHMARK(BM_StatePullChainIncremental)->RangeMultiplier(4)->Range(1, 4096);
+BENCHMARK(BM_ParallelChain)->RangeMultiplier(8)->Range(8, 4096)->UseRealTime();
+BENCHMARK(BM_ParallelChainFused)->RangeMultiplier(8)->Range(8, 4096)->UseRealTime();
+BENCHMARK(BM_GraphCompile)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GraphLoad)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TickLatency)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TickLatencyParallel)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+} // namespace ltb::ddf::bench
@@ -0,0 +1,68 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "synthetic_graph.hpp"
+
+// standard
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ltb::ddf::bench {
+
+auto make_layered_graph(std::size_t node_count, std::size_t width) -> ddf {
+    ddf graph;
+
+    width = std::max(std::min(width, node_count), std::size_t{1u});
+
+    std::vector<OutputPort<int>> previous_layer;
+    std::vector<OutputPort<int>> layer;
+
+    for (auto i = 0u; i < width; ++i) {
+        previous_layer.emplace_back(graph.add_source("source", [i] { return static_cast<int>(i); }));
+    }
+
+    auto seed = std::uint32_t{12345u};
+    auto next = [&seed, &previous_layer] {
+        seed = seed * 1664525u + 1013904223u; // LCG keeps the graph identical between runs
+        return previous_layer[(seed >> 8u) % previous_layer.size()];
+    };
+
+    for (auto n = width; n < node_count; ++n) {
+        layer.emplace_back(graph.add_transform("sum", [](int a, int b) { return a + b; }, next(), next()));
+
+        if (layer.size() == width) {
+            previous_layer.swap(layer);
+            layer.clear();
+        }
+    }
+
+    return graph;
+}
+
+auto report_percentiles(benchmark::State& state, Histogram const& histogram) -> void {
+    state.counters["p50_ns"]  = static_cast<double>(histogram.percentile(0.5));
+    state.counters["p99_ns"]  = static_cast<double>(histogram.percentile(0.99));
+    state.counters["p999_ns"] = static_cast<double>(histogram.percentile(0.999));
+}
+
+} // namespace ltb::ddf::bench
@@ -0,0 +1,49 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf/core/ddf.hpp"
+#include "ddf/core/profiler.hpp"
+
+// external
+#include <benchmark/benchmark.h>
+
+// standard
+#include <cstddef>
+
+namespace ltb::ddf::bench {
+
+/**
+ * @brief Builds a layered DAG of 'node_count' integer nodes.
+ *
+ * The first 'width' nodes are sources and every other node sums two outputs chosen
+ * pseudo-randomly from the previous layer, so the graph has a realistic mix of fan-in
+ * and fan-out and a depth of roughly node_count / width.
+ */
+auto make_layered_graph(std::size_t node_count, std::size_t width = 64u) -> ddf;
+
+/// \brief Reports the 50th, 99th and 99.9th percentiles of 'histogram' as benchmark counters
+auto report_percentiles(benchmark::State& state, Histogram const& histogram) -> void;
+
+} // namespace ltb::ddf::bench
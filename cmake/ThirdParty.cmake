@@ -9,6 +9,10 @@ FetchContent_Declare(ltb_flexcore_dl
         GIT_REPOSITORY https://github.com/LoganBarnes/flexcore.git
         GIT_TAG 7c0e465e73cc132a18340e9bdee8027ef058fb65 # master
         )
+FetchContent_Declare(ltb_benchmark_dl
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG v1.5.2
+        )
 
 ### ImGui Node Editor ###
 FetchContent_GetProperties(ltb_imgui_node_editor_dl)
@@ -92,3 +96,23 @@ if (NOT ltb_flexcore_dl_POPULATED)
 
     add_library(LtbExternal::Flexcore ALIAS flexcore)
 endif (NOT ltb_flexcore_dl_POPULATED)
+
+### Google Benchmark ###
+if (${LTB_DDF_BUILD_BENCHMARKS})
+    FetchContent_GetProperties(ltb_benchmark_dl)
+    if (NOT ltb_benchmark_dl_POPULATED)
+        FetchContent_Populate(ltb_benchmark_dl)
+
+        set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+        set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+        set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+        add_subdirectory(${ltb_benchmark_dl_SOURCE_DIR} ${ltb_benchmark_dl_BINARY_DIR} EXCLUDE_FROM_ALL)
+
+        ltb_add_external(benchmark Benchmark)
+        target_link_libraries(ltb_external_benchmark
+                INTERFACE
+                benchmark::benchmark_main
+                )
+    endif (NOT ltb_benchmark_dl_POPULATED)
+endif ()
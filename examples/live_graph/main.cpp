@@ -0,0 +1,62 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ddf/core/ddf.hpp"
+#include "ddf/core/graph_metrics.hpp"
+#include "ddf/core/region_scheduler.hpp"
+#include "ddf/viewer/main_window.hpp"
+
+// standard
+#include <chrono>
+#include <cmath>
+
+using namespace ltb;
+
+namespace {
+
+/// \brief Sensor -> smoothing -> an expensive stage with a cheap side branch -> outputs
+auto build_graph(ddf::ddf& graph) -> void {
+    auto sensor = graph.add_source("sensor", [t = 0.0]() mutable { return std::sin(t += 0.01); });
+    auto smooth = graph.add_transform(
+        "smooth", [last = 0.0](double x) mutable { return last += 0.1 * (x - last); }, sensor);
+    auto detect = graph.add_transform(
+        "detect",
+        [](double x) {
+            // Stands in for real work whose cost depends on the input
+            auto value = x;
+            for (auto i = 0; i < 20000 + static_cast<int>(20000.0 * std::abs(x)); ++i) {
+                value = std::sin(value);
+            }
+            return value;
+        },
+        smooth);
+    auto level = graph.add_transform("level", [](double x) { return x > 0.0; }, smooth);
+
+    graph.add_sink("log", [](double) {}, detect);
+    graph.add_sink("alarm", [](bool) {}, level);
+}
+
+} // namespace
+
+/// \brief Ticks a small graph on its own thread and shows its live metrics in the viewer
+auto main(int argc, char* argv[]) -> int {
+    ddf::ddf graph;
+    build_graph(graph);
+    graph.enable_profiling();
+    graph.compile().value_or_throw();
+
+    auto metrics = std::make_shared<ddf::MetricsSampler>();
+
+    ddf::vis::MainWindow window({argc, argv});
+    window.watch(ddf::capture_topology(graph), metrics);
+
+    auto options       = ddf::RegionOptions{std::chrono::milliseconds(10)};
+    options.after_tick = [metrics](ddf::ddf& ticked) { metrics->sample(ticked); };
+
+    // Declared after the graph so it stops ticking before the graph is destroyed
+    ddf::RegionScheduler scheduler(1u);
+    scheduler.add_region("live", graph, std::move(options));
+    scheduler.start();
+
+    return window.exec();
+}
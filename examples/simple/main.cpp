@@ -5,10 +5,21 @@
 
 #include "ddf/core/ddf.hpp"
 
+#include <iostream>
+
 using namespace ltb;
 
 auto main() -> int {
-    ddf::ddf ddf;
+    ddf::ddf graph;
+
+    auto temperature = graph.add_source("temperature", [] { return 42; });
+    auto fahrenheit  = graph.add_transform("to fahrenheit", [](int c) { return c * 9 / 5 + 32; }, temperature);
+    graph.add_sink(
+        "print", [](int f) { std::cout << "Current temperature is: " << f << "F" << std::endl; }, fahrenheit);
+
+    graph.compile().value_or_throw();
+    graph.tick();
+
     return 0;
 }
 
@@ -57,5 +57,10 @@ auto NilScene::actually_get_item_info(SceneId const& /*item_id*/, InfoGetterFunc
     return util11::success();
 }
 
+auto NilScene::actually_batch(SceneBatchFunc const& func) -> util11::Error {
+    func(*this);
+    return util11::success();
+}
+
 } // namespace gvs
 } // namespace ltb
@@ -54,6 +54,7 @@ private:
 
     auto actually_get_item_info(SceneId const& item_id, InfoGetterFunc info_getter) const
         -> ltb::util11::Error override;
+    auto actually_batch(SceneBatchFunc const& func) -> ltb::util11::Error override;
     /*
      * End `Scene` functions
      */
@@ -75,7 +75,7 @@ private:
 ///
 /// \brief A "named parameter" wrapper used to set geometry info for items in a StaticScene
 ///
-template <typename T, T GeometryInfo::*member>
+template <typename T, SharedBuffer<T> GeometryInfo::*member>
 struct SceneGeometryChecker {
     explicit SceneGeometryChecker(bool* value) : data_(value) {}
 
@@ -66,11 +66,11 @@ private:
 ///
 /// \brief A "named parameter" wrapper used to set geometry info for items in a StaticScene
 ///
-template <typename T, T GeometryInfo::*member>
+template <typename T, SharedBuffer<T> GeometryInfo::*member>
 struct SceneGeometryGetter {
     explicit SceneGeometryGetter(T* value) : data_(value) {}
 
-    auto operator()(SceneItemInfo const& info) -> void { *data_ = info.geometry_info.*member; }
+    auto operator()(SceneItemInfo const& info) -> void { *data_ = (info.geometry_info.*member).get(); }
 
     SceneGeometryGetter(SceneGeometryGetter const&)     = delete;
     SceneGeometryGetter(SceneGeometryGetter&&) noexcept = delete;
@@ -27,5 +27,13 @@ namespace gvs {
 
 Scene::~Scene() = default;
 
+auto Scene::batch(SceneBatchFunc const& func) -> void {
+    safe_batch(func).throw_if_error();
+}
+
+auto Scene::safe_batch(SceneBatchFunc const& func) -> util11::Error {
+    return actually_batch(func);
+}
+
 } // namespace gvs
 } // namespace ltb
@@ -27,6 +27,7 @@
 #include "types.hpp"
 
 // standard
+#include <functional>
 #include <random>
 #include <unordered_set>
 
@@ -34,6 +35,7 @@ namespace ltb {
 namespace gvs {
 
 using InfoGetterFunc = std::function<void(SceneItemInfo const&)>;
+using SceneBatchFunc = std::function<void(Scene& batch)>;
 
 class Scene {
 public:
@@ -62,6 +64,7 @@ public:
     /// \brief Modifies an existing item in the scene using named parameters.
     ///        Any geometry parameters will appended their data to the corresponding info for this item.
     ///        Any non-geometry parameters will replace their corresponding info for this item.
+    ///        Appended vertex attributes must have one value per appended position.
     ///
     ///     Example:
     ///     ```cpp
@@ -82,6 +85,22 @@ public:
     template <typename... Functors>
     auto get_item_info(SceneId const& item_id, Functors&&... functors) -> void;
 
+    /// \brief Makes many changes to the scene at once. Every change made through 'batch' inside 'func'
+    ///        happens while the scene is locked once and displays are sent one merged update per item
+    ///        when 'func' returns, so adding thousands of items costs one round trip instead of thousands.
+    ///
+    ///        Only use 'batch' (not this scene) inside 'func'. Changes are not undone if 'func' throws.
+    ///
+    ///     Example:
+    ///     ```cpp
+    ///     scene.batch([&](gvs::Scene& batch) {
+    ///         for (auto const& points : all_points) {
+    ///             batch.add_item(gvs::SetPositions3d(points), gvs::SetParent(parent_id));
+    ///         }
+    ///     });
+    ///     ```
+    auto batch(SceneBatchFunc const& func) -> void;
+
     template <typename... Functors>
     auto safe_add_item(Functors&&... functors) -> util11::Result<SceneId>;
 
@@ -94,6 +113,8 @@ public:
     template <typename... Functors>
     auto safe_get_item_info(SceneId const& item_id, Functors&&... functors) -> util11::Error;
 
+    auto safe_batch(SceneBatchFunc const& func) -> util11::Error;
+
     /// \brief The ids of all items in the scene
     virtual auto item_ids() const -> std::unordered_set<SceneId> = 0;
 
@@ -115,6 +136,9 @@ private:
 
     /// \brief Updates the specified item by appending all new geometry
     virtual auto actually_get_item_info(SceneId const& item_id, InfoGetterFunc info_getter) const -> util11::Error = 0;
+
+    /// \brief Calls 'func' with a scene that applies its changes as a single batch
+    virtual auto actually_batch(SceneBatchFunc const& func) -> util11::Error = 0;
 };
 
 namespace detail {
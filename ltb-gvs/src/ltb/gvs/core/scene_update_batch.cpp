@@ -0,0 +1,477 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Geometry Visualization Server
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "scene_update_batch.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <string>
+#include <vector>
+
+namespace ltb {
+namespace gvs {
+namespace {
+
+template <typename T>
+auto append_buffer(SharedBuffer<T>* buffer, SharedBuffer<T> const& more) -> void {
+    if (more.empty()) {
+        return;
+    }
+    if (buffer->empty()) {
+        *buffer = more; // Shares the data instead of copying it
+        return;
+    }
+    buffer->modify([&more](T& data) { data.insert(data.end(), more.begin(), more.end()); });
+}
+
+template <std::size_t N>
+auto append_buffer(SharedBuffer<AttributeVector<N>>* buffer, SharedBuffer<AttributeVector<N>> const& more) -> void {
+    if (more.empty()) {
+        return;
+    }
+    if (buffer->empty()) {
+        *buffer = more;
+        return;
+    }
+    buffer->modify([&more](AttributeVector<N>& data) { data.append(more.get()); });
+}
+
+auto mark_appended(UpdatedInfo* updated, GeometryInfo const& appended) -> void {
+    auto const vertices = !(appended.positions.empty() && appended.normals.empty()
+                            && appended.texture_coordinates.empty() && appended.vertex_colors.empty());
+    auto const indices = !appended.indices.empty();
+
+    updated->geometry |= (vertices || indices);
+    updated->geometry_vertices |= vertices;
+    updated->geometry_indices |= indices;
+}
+
+auto append_geometry(GeometryInfo* geometry, GeometryInfo const& more) -> void {
+    append_buffer(&geometry->positions, more.positions);
+    append_buffer(&geometry->normals, more.normals);
+    append_buffer(&geometry->texture_coordinates, more.texture_coordinates);
+    append_buffer(&geometry->vertex_colors, more.vertex_colors);
+    append_buffer(&geometry->indices, more.indices);
+}
+
+} // namespace
+
+SceneUpdateBatch::SceneUpdateBatch()  = default;
+SceneUpdateBatch::~SceneUpdateBatch() = default;
+
+auto SceneUpdateBatch::added(SceneId const& item_id, SceneItemInfo const& item) -> void {
+    auto& updates = touch(item_id);
+    updates       = ItemUpdates{};
+    updates.added = true;
+    updates.item  = item;
+}
+
+auto SceneUpdateBatch::updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void {
+    auto& updates = touch(item_id);
+    updates.item  = item;
+
+    if (updates.added) {
+        // 'added' reports the whole item, including anything appended so far
+        updates.appended     = {};
+        updates.has_appended = false;
+        return;
+    }
+
+    if (updates.updated) {
+        *updates.updated |= updated;
+    } else {
+        updates.updated = std::make_unique<UpdatedInfo>(updated);
+    }
+
+    if (updates.updated->geometry && updates.has_appended) {
+        // The new data already contains the appended geometry and its buffers will be uploaded anyway
+        mark_appended(updates.updated.get(), updates.appended);
+        updates.appended     = {};
+        updates.has_appended = false;
+    }
+}
+
+auto SceneUpdateBatch::appended(SceneId const& item_id, GeometryInfo const& appended) -> void {
+    // Kept separate from the item's data, even if its buffers will be uploaded anyway, since adding
+    // to them would copy the whole item while the scene still shares it. The tail is replayed after
+    // the item's 'added' or 'updated' notification instead.
+    auto& updates = touch(item_id);
+    append_geometry(&updates.appended, appended);
+    updates.has_appended = true;
+}
+
+auto SceneUpdateBatch::removed(SceneId const& item_id) -> void {
+    auto&      updates   = touch(item_id);
+    bool const was_added = updates.added;
+    updates              = ItemUpdates{};
+    // Nothing needs to be reported for an item that only existed during the batch
+    updates.removed = !was_added;
+}
+
+auto SceneUpdateBatch::reset_items(SceneItems const& items) -> void {
+    // Nothing recorded so far matters once every item has been replaced
+    reset_       = true;
+    reset_items_ = items;
+    order_.clear();
+    items_.clear();
+}
+
+auto SceneUpdateBatch::replay(SceneUpdateHandler* handler) -> void {
+    replay_until(handler, std::chrono::steady_clock::time_point::max());
+}
+
+auto SceneUpdateBatch::replay_until(SceneUpdateHandler* handler, std::chrono::steady_clock::time_point deadline)
+    -> bool {
+    if (reset_) {
+        SceneItems items;
+        std::swap(items, reset_items_);
+        reset_ = false;
+        handler->reset_items(items);
+    }
+
+    bool first = true;
+    while (!order_.empty() && (first || std::chrono::steady_clock::now() < deadline)) {
+        auto item_id = std::move(order_.front());
+        order_.pop_front();
+
+        // Items may have already been reported before their children
+        if (items_.find(item_id) != items_.end()) {
+            replay_item(item_id, handler);
+            first = false;
+        }
+    }
+
+    return empty();
+}
+
+auto SceneUpdateBatch::empty() const -> bool {
+    return !reset_ && items_.empty();
+}
+
+auto SceneUpdateBatch::touch(SceneId const& item_id) -> ItemUpdates& {
+    auto iter = items_.find(item_id);
+    if (iter == items_.end()) {
+        order_.emplace_back(item_id);
+        iter = items_.emplace(item_id, ItemUpdates{}).first;
+    }
+    return iter->second;
+}
+
+auto SceneUpdateBatch::replay_item(SceneId const& item_id, SceneUpdateHandler* handler) -> void {
+    auto iter = items_.find(item_id);
+    if (iter == items_.end()) {
+        return;
+    }
+
+    // Removed from the batch before reporting so an exception thrown by 'handler' is not repeated on the next replay
+    auto updates = std::move(iter->second);
+    items_.erase(iter);
+
+    if (updates.removed) {
+        handler->removed(item_id);
+        return;
+    }
+
+    if (updates.added || updates.updated) {
+        // The item's parent may have been added later in the batch
+        replay_item(updates.item.parent, handler);
+
+        if (updates.added) {
+            handler->added(item_id, updates.item);
+        } else {
+            handler->updated(item_id, *updates.updated, updates.item);
+        }
+    }
+
+    if (updates.has_appended) {
+        handler->appended(item_id, updates.appended);
+    }
+}
+
+namespace {
+
+/// \brief Records every notification as a readable string
+class RecordingHandler : public SceneUpdateHandler {
+public:
+    std::unordered_map<SceneId, std::string> names;
+    std::vector<std::string>                 calls;
+
+    auto added(SceneId const& item_id, SceneItemInfo const& item) -> void override {
+        calls.emplace_back("added " + names.at(item_id) + vertices(item.geometry_info));
+    }
+
+    auto updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void override {
+        std::string fields;
+        fields += (updated.geometry_vertices ? " vertices" : "");
+        fields += (updated.geometry_indices ? " indices" : "");
+        fields += (updated.display ? " display" : "");
+        fields += (updated.parent ? " parent" : "");
+        fields += (updated.children ? " children" : "");
+        calls.emplace_back("updated " + names.at(item_id) + fields + vertices(item.geometry_info));
+    }
+
+    auto appended(SceneId const& item_id, GeometryInfo const& appended) -> void override {
+        calls.emplace_back("appended " + names.at(item_id) + vertices(appended));
+    }
+
+    auto removed(SceneId const& item_id) -> void override { calls.emplace_back("removed " + names.at(item_id)); }
+
+    auto reset_items(SceneItems const& items) -> void override {
+        calls.emplace_back("reset " + std::to_string(items.size()));
+    }
+
+private:
+    static auto vertices(GeometryInfo const& geometry) -> std::string {
+        return " (" + std::to_string(geometry.positions.size() / 3u) + ")";
+    }
+};
+
+struct BatchFixture {
+    std::mt19937     generator{0u};
+    SceneId          a = generate_scene_id(generator);
+    SceneId          b = generate_scene_id(generator);
+    SceneId          c = generate_scene_id(generator);
+    RecordingHandler handler;
+    SceneUpdateBatch batch;
+
+    BatchFixture() {
+        handler.names[a] = "a";
+        handler.names[b] = "b";
+        handler.names[c] = "c";
+    }
+
+    auto replay() -> std::vector<std::string> {
+        handler.calls.clear();
+        batch.replay(&handler);
+        return handler.calls;
+    }
+
+    /// \brief Replays with a deadline that has already passed
+    auto replay_late(bool* finished) -> std::vector<std::string> {
+        handler.calls.clear();
+        *finished = batch.replay_until(&handler, std::chrono::steady_clock::time_point::min());
+        return handler.calls;
+    }
+};
+
+auto geometry(std::size_t vertex_count) -> GeometryInfo {
+    GeometryInfo geometry;
+    geometry.positions = AttributeVector<3>(std::vector<float>(vertex_count * 3u, 0.f));
+    return geometry;
+}
+
+auto item(std::size_t vertex_count, SceneId const& parent = nil_id()) -> SceneItemInfo {
+    SceneItemInfo item;
+    item.geometry_info = geometry(vertex_count);
+    item.parent        = parent;
+    return item;
+}
+
+auto fields(bool vertices, bool indices, bool display) -> UpdatedInfo {
+    UpdatedInfo updated{SparseSceneItemInfo{}};
+    updated.geometry          = (vertices || indices);
+    updated.geometry_vertices = vertices;
+    updated.geometry_indices  = indices;
+    updated.display           = display;
+    return updated;
+}
+
+using Calls = std::vector<std::string>;
+
+} // namespace
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch reports an added item once with its latest data") {
+    BatchFixture test;
+
+    test.batch.added(test.a, item(1));
+    test.batch.updated(test.a, fields(false, false, true), item(1));
+    test.batch.updated(test.a, fields(true, false, false), item(4));
+
+    CHECK(test.replay() == Calls{"added a (4)"});
+    CHECK(test.batch.empty());
+    CHECK(test.replay().empty());
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch merges repeated updates") {
+    BatchFixture test;
+
+    test.batch.updated(test.a, fields(false, false, true), item(1));
+    test.batch.updated(test.b, fields(false, true, false), item(1));
+    test.batch.updated(test.a, fields(true, false, false), item(2));
+    test.batch.updated(test.a, fields(false, false, true), item(3));
+
+    CHECK(test.replay() == Calls{"updated a vertices display (3)", "updated b indices (1)"});
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch concatenates appended geometry") {
+    BatchFixture test;
+
+    SUBCASE("existing item") {
+        test.batch.appended(test.a, geometry(1));
+        test.batch.updated(test.a, fields(false, false, true), item(3));
+        test.batch.appended(test.a, geometry(2));
+
+        CHECK(test.replay() == Calls{"updated a display (3)", "appended a (3)"});
+    }
+
+    SUBCASE("pending add") {
+        test.batch.added(test.a, item(1));
+        test.batch.appended(test.a, geometry(1));
+        test.batch.appended(test.a, geometry(2));
+
+        CHECK(test.replay() == Calls{"added a (1)", "appended a (3)"});
+    }
+
+    SUBCASE("pending geometry update") {
+        test.batch.updated(test.a, fields(true, false, false), item(1));
+        test.batch.appended(test.a, geometry(2));
+
+        CHECK(test.replay() == Calls{"updated a vertices (1)", "appended a (2)"});
+    }
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch drops appends replaced by a geometry update") {
+    BatchFixture test;
+
+    SUBCASE("update") {
+        test.batch.appended(test.a, geometry(2));
+        // Only indices are replaced so the vertices are marked as updated to upload the appended ones
+        test.batch.updated(test.a, fields(false, true, false), item(3));
+
+        CHECK(test.replay() == Calls{"updated a vertices indices (3)"});
+    }
+
+    SUBCASE("add") {
+        test.batch.added(test.a, item(1));
+        test.batch.appended(test.a, geometry(2));
+        test.batch.updated(test.a, fields(false, false, true), item(3));
+
+        CHECK(test.replay() == Calls{"added a (3)"});
+    }
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch reports removed items") {
+    BatchFixture test;
+
+    test.batch.added(test.a, item(1));
+    test.batch.updated(test.b, fields(false, false, true), item(1));
+    test.batch.appended(test.b, geometry(1));
+    test.batch.removed(test.a);
+    test.batch.removed(test.b);
+
+    // 'a' only existed during the batch
+    CHECK(test.replay() == Calls{"removed b"});
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch reset_items replaces earlier changes") {
+    BatchFixture test;
+
+    test.batch.added(test.a, item(1));
+    test.batch.updated(test.b, fields(false, false, true), item(1));
+
+    SceneItems items;
+    items[test.b] = item(1);
+    test.batch.reset_items(items);
+
+    test.batch.added(test.c, item(2, test.b));
+
+    CHECK(test.replay() == Calls{"reset 1", "added c (2)"});
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch reports parents before their children") {
+    BatchFixture test;
+
+    test.batch.added(test.a, item(1));
+    test.batch.added(test.b, item(1));
+    test.batch.updated(test.c, fields(false, false, false), item(1, test.a));
+    // 'a' is moved under 'b', which was added after it
+    test.batch.updated(test.a, fields(false, false, false), item(1, test.b));
+
+    CHECK(test.replay() == Calls{"added b (1)", "added a (1)", "updated c (1)"});
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch replay_until keeps what it could not replay") {
+    BatchFixture test;
+
+    test.batch.added(test.a, item(1));
+    test.batch.added(test.b, item(2));
+    test.batch.added(test.c, item(3));
+
+    bool finished = true;
+    CHECK(test.replay_late(&finished) == Calls{"added a (1)"});
+    CHECK_FALSE(finished);
+    CHECK_FALSE(test.batch.empty());
+
+    CHECK(test.replay_late(&finished) == Calls{"added b (2)"});
+    CHECK_FALSE(finished);
+
+    CHECK(test.replay_late(&finished) == Calls{"added c (3)"});
+    CHECK(finished);
+    CHECK(test.batch.empty());
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch replay_until always reports at least one item") {
+    BatchFixture test;
+
+    SceneItems items;
+    items[test.a] = item(1);
+    test.batch.reset_items(items);
+
+    test.batch.updated(test.a, fields(false, false, true), item(1));
+    test.batch.added(test.b, item(1));
+    // 'b' will be reported early as the parent of 'a'
+    test.batch.updated(test.a, fields(false, false, false), item(1, test.b));
+    test.batch.added(test.c, item(1));
+
+    bool finished = true;
+    CHECK(test.replay_late(&finished) == Calls{"reset 1", "added b (1)", "updated a display (1)"});
+    CHECK_FALSE(finished);
+
+    // The stale entry for 'b' does not count as the item reported this time
+    CHECK(test.replay_late(&finished) == Calls{"added c (1)"});
+    CHECK(finished);
+}
+
+TEST_CASE("[ltb][gvs] SceneUpdateBatch merges new updates into a partly replayed batch") {
+    BatchFixture test;
+
+    test.batch.added(test.a, item(1));
+    test.batch.added(test.b, item(1));
+
+    bool finished = true;
+    CHECK(test.replay_late(&finished) == Calls{"added a (1)"});
+
+    // Updates queued during the next frame are merged the same way DisplayWindow merges them
+    SceneUpdateBatch queued;
+    queued.updated(test.b, fields(false, false, true), item(2));
+    queued.appended(test.a, geometry(1));
+    queued.updated(test.c, fields(false, false, true), item(1));
+    queued.replay(&test.batch);
+    CHECK(queued.empty());
+
+    CHECK(test.replay() == Calls{"added b (2)", "appended a (1)", "updated c display (1)"});
+}
+
+} // namespace gvs
+} // namespace ltb
@@ -0,0 +1,93 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Geometry Visualization Server
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "scene_update_handler.hpp"
+
+// standard
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+namespace ltb {
+namespace gvs {
+
+/// \brief Records scene update notifications so they can be handed to another handler all at once.
+///
+///        Notifications are merged per item: an item that is added and then changed is only reported
+///        as added, repeated updates are reported once with every updated field and the latest data,
+///        and appended geometry is concatenated into a single append (or dropped if a later update
+///        replaces the geometry). Each item is reported at most once per replay, followed by at most one
+///        append.
+class SceneUpdateBatch : public SceneUpdateHandler {
+public:
+    explicit SceneUpdateBatch();
+    ~SceneUpdateBatch() override;
+
+    /*
+     * Start `SceneUpdateHandler` functions
+     */
+    auto added(SceneId const& item_id, SceneItemInfo const& item) -> void override;
+    auto updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void override;
+    auto appended(SceneId const& item_id, GeometryInfo const& appended) -> void override;
+    auto removed(SceneId const& item_id) -> void override;
+    auto reset_items(SceneItems const& items) -> void override;
+    /*
+     * End `SceneUpdateHandler` functions
+     */
+
+    /// \brief Reports the merged notifications to 'handler' and removes them from the batch.
+    ///        Parents are reported before their children.
+    auto replay(SceneUpdateHandler* handler) -> void;
+
+    /// \brief Like 'replay' but stops once 'deadline' has passed. At least one item is always reported.
+    /// \returns true if every notification was reported.
+    auto replay_until(SceneUpdateHandler* handler, std::chrono::steady_clock::time_point deadline) -> bool;
+
+    /// \brief True if no notifications have been recorded
+    auto empty() const -> bool;
+
+private:
+    struct ItemUpdates {
+        bool                         added        = false;
+        bool                         removed      = false;
+        bool                         has_appended = false;
+        std::unique_ptr<UpdatedInfo> updated      = nullptr; ///< Null if the item was not updated
+        GeometryInfo                 appended     = {}; ///< Geometry appended after the latest data, in order
+        SceneItemInfo                item         = {}; ///< The latest data if the item was added or updated
+    };
+
+    auto touch(SceneId const& item_id) -> ItemUpdates&;
+
+    auto replay_item(SceneId const& item_id, SceneUpdateHandler* handler) -> void;
+
+    bool                                     reset_ = false; ///< All items were replaced before the changes below
+    SceneItems                               reset_items_; ///< The replacement items if 'reset_' is set
+    std::deque<SceneId>                      order_; ///< Items in the order they were first changed
+    std::unordered_map<SceneId, ItemUpdates> items_; ///< The merged changes to each item
+};
+
+} // namespace gvs
+} // namespace ltb
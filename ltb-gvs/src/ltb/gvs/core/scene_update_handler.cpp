@@ -85,6 +85,18 @@ auto UpdatedInfo::children_only() -> UpdatedInfo {
     return info;
 }
 
+auto UpdatedInfo::operator|=(UpdatedInfo const& other) -> UpdatedInfo& {
+    geometry |= other.geometry;
+    geometry_vertices |= other.geometry_vertices;
+    geometry_indices |= other.geometry_indices;
+    display |= other.display;
+    display_geometry_format |= other.display_geometry_format;
+    display_visible |= other.display_visible;
+    parent |= other.parent;
+    children |= other.children;
+    return *this;
+}
+
 SceneUpdateHandler::~SceneUpdateHandler() = default;
 
 } // namespace gvs
@@ -44,6 +44,9 @@ struct UpdatedInfo {
     static auto everything_but_geometry() -> UpdatedInfo;
     static auto children_only() -> UpdatedInfo;
 
+    /// \brief Marks every field that was updated in either info as updated.
+    auto operator|=(UpdatedInfo const& other) -> UpdatedInfo&;
+
 private:
     UpdatedInfo() = default;
 };
@@ -67,6 +70,13 @@ public:
      */
     virtual auto updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void = 0;
 
+    /**
+     * @brief Called when a Scene has appended geometry to an item.
+     * @param item_id - The id of the item.
+     * @param appended - Only the appended geometry. Indices are already offset to index the whole item.
+     */
+    virtual auto appended(SceneId const& item_id, GeometryInfo const& appended) -> void = 0;
+
     /**
      * @brief Called when a Scene has removed an item.
      * @param item_id - The id of the item to be deleted.
@@ -0,0 +1,94 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Geometry Visualization Server
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "types.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+namespace ltb {
+namespace gvs {
+namespace {
+
+using Indices = std::vector<unsigned>;
+
+TEST_CASE("[ltb][gvs] SharedBuffer copies share data") {
+    SharedBuffer<Indices> buffer(Indices{1u, 2u, 3u});
+    SharedBuffer<Indices> copy = buffer;
+
+    CHECK(copy.shares_data_with(buffer));
+    CHECK(copy.data() == buffer.data());
+
+    buffer = Indices{4u};
+    CHECK_FALSE(copy.shares_data_with(buffer));
+    CHECK(copy.get() == Indices{1u, 2u, 3u});
+}
+
+TEST_CASE("[ltb][gvs] SharedBuffer modify copies shared data first") {
+    SharedBuffer<Indices> buffer(Indices{1u, 2u, 3u});
+    SharedBuffer<Indices> copy   = buffer;
+    auto const*           before = buffer.data();
+
+    buffer.modify([](Indices& indices) { indices[0] = 7u; });
+
+    CHECK(buffer.get() == Indices{7u, 2u, 3u});
+    CHECK(buffer.data() != before);
+
+    // The copy taken before 'modify' still sees the old data
+    CHECK(copy.get() == Indices{1u, 2u, 3u});
+    CHECK(copy.data() == before);
+    CHECK_FALSE(copy.shares_data_with(buffer));
+}
+
+TEST_CASE("[ltb][gvs] SharedBuffer modify changes unshared data in place") {
+    SharedBuffer<Indices> buffer(Indices{1u, 2u, 3u});
+    auto const*           before = buffer.data();
+
+    buffer.modify([](Indices& indices) { indices[0] = 7u; });
+
+    CHECK(buffer.get() == Indices{7u, 2u, 3u});
+    CHECK(buffer.data() == before);
+
+    // Copies that have been released no longer force a copy
+    {
+        SharedBuffer<Indices> copy = buffer;
+        CHECK(copy.shares_data_with(buffer));
+    }
+    buffer.modify([](Indices& indices) { indices[1] = 8u; });
+
+    CHECK(buffer.get() == Indices{7u, 8u, 3u});
+    CHECK(buffer.data() == before);
+}
+
+TEST_CASE("[ltb][gvs] SharedBuffer modify on an empty buffer") {
+    SharedBuffer<AttributeVector<3>> buffer;
+    CHECK(buffer.empty());
+
+    buffer.modify([](AttributeVector<3>& positions) { positions.append(AttributeVector<3>{{1.f, 2.f, 3.f}}); });
+
+    CHECK(buffer.size() == 3u);
+    CHECK(SharedBuffer<AttributeVector<3>>().empty());
+}
+
+} // namespace
+} // namespace gvs
+} // namespace ltb
@@ -33,8 +33,10 @@
 
 // standard
 #include <array>
+#include <atomic>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ltb {
@@ -95,10 +97,61 @@ public:
     auto empty() const -> bool { return data_.empty(); }
     auto empty() -> bool { return data_.empty(); }
 
+    auto append(AttributeVector const& other) -> void { data_.insert(data_.end(), other.begin(), other.end()); }
+
 private:
     std::vector<float> data_;
 };
 
+/// \brief Data shared by every copy so copying is O(1) no matter how large the data is.
+///
+/// Shared data is never modified. Assigning new data replaces the shared pointer and 'modify'
+/// copies the data first if it is shared, so copies handed to other threads (scene update
+/// notifications, for example) never see a change.
+template <typename T>
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    SharedBuffer(T data) : data_(std::make_shared<T>(std::move(data))) {}
+
+    auto get() const -> T const& { return data_ ? *data_ : empty_value(); }
+
+    auto begin() const -> decltype(std::declval<T const&>().begin()) { return get().begin(); }
+    auto end() const -> decltype(std::declval<T const&>().end()) { return get().end(); }
+    auto data() const -> decltype(std::declval<T const&>().data()) { return get().data(); }
+    auto size() const -> decltype(std::declval<T const&>().size()) { return get().size(); }
+    auto empty() const -> bool { return get().empty(); }
+
+    /// \brief True if both refer to the same data (not just equal data)
+    auto shares_data_with(SharedBuffer const& other) const -> bool { return data_ == other.data_; }
+
+    /// \brief Calls 'modify(T&)' on the data in place if no other copy shares it, otherwise on a
+    ///        private copy first. Only the thread that owns this buffer may call it.
+    template <typename Modify>
+    auto modify(Modify&& modify) -> void {
+        if (!data_) {
+            data_ = std::make_shared<T>(empty_value());
+        } else if (data_.use_count() > 1) {
+            data_ = std::make_shared<T>(*data_);
+        } else {
+            // The last other copy may have just been released on another thread. Make sure its
+            // reads are finished before writing.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        modify(*data_);
+    }
+
+private:
+    std::shared_ptr<T> data_ = nullptr; ///< Null when empty. Never modified while shared.
+
+    static auto empty_value() -> T const& {
+        static T const value = {};
+        return value;
+    }
+};
+
 enum class GeometryFormat : int32_t {
     Points = 0,
     Lines,
@@ -187,11 +240,11 @@ struct DisplayInfo {
 };
 
 struct GeometryInfo {
-    AttributeVector<3>    positions           = {};
-    AttributeVector<3>    normals             = {};
-    AttributeVector<2>    texture_coordinates = {};
-    AttributeVector<3>    vertex_colors       = {};
-    std::vector<unsigned> indices             = {};
+    SharedBuffer<AttributeVector<3>>    positions           = {};
+    SharedBuffer<AttributeVector<3>>    normals             = {};
+    SharedBuffer<AttributeVector<2>>    texture_coordinates = {};
+    SharedBuffer<AttributeVector<3>>    vertex_colors       = {};
+    SharedBuffer<std::vector<unsigned>> indices             = {};
 };
 
 struct SceneItemInfo {
@@ -36,6 +36,8 @@ auto EmptyBackend::added(SceneId const& /*item_id*/, SceneItemInfo const & /*ite
 auto EmptyBackend::updated(SceneId const& /*item_id*/, UpdatedInfo const& /*updated*/, SceneItemInfo const & /*item*/)
     -> void {}
 
+auto EmptyBackend::appended(SceneId const& /*item_id*/, GeometryInfo const & /*appended*/) -> void {}
+
 auto EmptyBackend::removed(SceneId const & /*item_id*/) -> void {}
 
 auto EmptyBackend::reset_items(SceneItems const & /*items*/) -> void {}
@@ -37,6 +37,7 @@ public:
 
     auto added(SceneId const& item_id, SceneItemInfo const& item) -> void override;
     auto updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void override;
+    auto appended(SceneId const& item_id, GeometryInfo const& appended) -> void override;
     auto removed(SceneId const& item_id) -> void override;
 
     auto reset_items(SceneItems const& items) -> void override;
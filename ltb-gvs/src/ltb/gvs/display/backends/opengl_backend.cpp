@@ -36,63 +36,187 @@
 #include <Magnum/GL/RenderbufferFormat.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/Mesh.h>
-#include <Magnum/MeshTools/CompressIndices.h>
 
 // standard
 #include <iostream>
+#include <numeric>
 
 using namespace Magnum;
 
 namespace ltb::gvs {
 namespace {
 
+/// \brief Floats per vertex of each attribute, in the order of 'MeshData::attribute_components'
+constexpr auto attribute_sizes = std::array<int, 4>{3, 3, 2, 3};
+
+auto attribute_views(GeometryInfo const& geometry_info) -> std::array<Containers::ArrayView<float const>, 4> {
+    return {{
+        {geometry_info.positions.data(), geometry_info.positions.size()},
+        {geometry_info.normals.data(), geometry_info.normals.size()},
+        {geometry_info.texture_coordinates.data(), geometry_info.texture_coordinates.size()},
+        {geometry_info.vertex_colors.data(), geometry_info.vertex_colors.size()},
+    }};
+}
+
+/// \brief Byte offset of the block holding attribute 'a' in a vertex buffer with room for 'capacity' vertices
+auto attribute_offset(MeshData const& mesh_data, std::size_t a, int capacity) -> GLintptr {
+    auto floats_before = 0;
+    for (auto i = 0u; i < a; ++i) {
+        floats_before += mesh_data.attribute_components[i];
+    }
+    return static_cast<GLintptr>(floats_before) * capacity * static_cast<GLintptr>(sizeof(float));
+}
+
+auto bind_attributes(MeshData* mesh_data) -> void {
+    auto const& components = mesh_data->attribute_components;
+    auto const  capacity   = mesh_data->vbo_capacity;
+
+    if (components[0] > 0) {
+        mesh_data->mesh.addVertexBuffer(mesh_data->vertex_buffer,
+                                        attribute_offset(*mesh_data, 0u, capacity),
+                                        GeneralShader::Position{});
+    }
+    if (components[1] > 0) {
+        mesh_data->mesh.addVertexBuffer(mesh_data->vertex_buffer,
+                                        attribute_offset(*mesh_data, 1u, capacity),
+                                        GeneralShader::Normal{});
+    }
+    if (components[2] > 0) {
+        mesh_data->mesh.addVertexBuffer(mesh_data->vertex_buffer,
+                                        attribute_offset(*mesh_data, 2u, capacity),
+                                        GeneralShader::TextureCoordinate{});
+    }
+    if (components[3] > 0) {
+        mesh_data->mesh.addVertexBuffer(mesh_data->vertex_buffer,
+                                        attribute_offset(*mesh_data, 3u, capacity),
+                                        GeneralShader::VertexColor{});
+    }
+}
+
 auto update_vbo(MeshData* mesh_data, GeometryInfo const& geometry_info) -> void {
+    auto const attributes = attribute_views(geometry_info);
 
     std::vector<float> buffer_data;
-    GLintptr           offset = 0;
-    mesh_data->vbo_count      = 0;
+    for (auto a = 0u; a < attributes.size(); ++a) {
+        mesh_data->attribute_components[a] = attributes[a].empty() ? 0 : attribute_sizes[a];
+        buffer_data.insert(buffer_data.end(), attributes[a].begin(), attributes[a].end());
+    }
 
-    auto update_attribute = [&mesh_data, &offset, &buffer_data](auto const& attribute, auto const& shader_attribute) {
-        buffer_data.insert(buffer_data.end(), attribute.data(), (attribute.data() + attribute.size()));
-        mesh_data->mesh.addVertexBuffer(mesh_data->vertex_buffer, offset, shader_attribute);
+    mesh_data->vbo_count    = static_cast<int>(geometry_info.positions.size() / 3u);
+    mesh_data->vbo_capacity = mesh_data->vbo_count;
 
-        auto isize = static_cast<int>(attribute.size());
-        offset += isize * static_cast<int>(sizeof(float));
-        return isize;
-    };
+    mesh_data->vertex_buffer.setData(buffer_data, GL::BufferUsage::StaticDraw);
+    bind_attributes(mesh_data);
+    mesh_data->mesh.setCount(mesh_data->vbo_count);
+}
+
+/// \brief Moves the vertices into a new buffer with room for 'capacity' vertices without reading them back
+auto grow_vbo(MeshData* mesh_data, int capacity) -> void {
+    auto const& components = mesh_data->attribute_components;
+
+    auto const floats_per_vertex = std::accumulate(components.begin(), components.end(), 0);
+
+    GL::Buffer buffer;
+    buffer.setData({nullptr, static_cast<std::size_t>(floats_per_vertex * capacity) * sizeof(float)},
+                   GL::BufferUsage::DynamicDraw);
 
-    if (!geometry_info.positions.empty()) {
-        auto attribute_size  = update_attribute(geometry_info.positions, GeneralShader::Position{});
-        mesh_data->vbo_count = attribute_size / 3;
+    for (auto a = 0u; a < components.size(); ++a) {
+        if (components[a] > 0 && mesh_data->vbo_count > 0) {
+            GL::Buffer::copy(mesh_data->vertex_buffer,
+                             buffer,
+                             attribute_offset(*mesh_data, a, mesh_data->vbo_capacity),
+                             attribute_offset(*mesh_data, a, capacity),
+                             static_cast<GLsizeiptr>(components[a] * mesh_data->vbo_count * sizeof(float)));
+        }
     }
 
-    if (!geometry_info.normals.empty()) {
-        update_attribute(geometry_info.normals, GeneralShader::Normal{});
+    mesh_data->vertex_buffer = std::move(buffer);
+    mesh_data->vbo_capacity  = capacity;
+    bind_attributes(mesh_data);
+}
+
+auto append_vbo(MeshData* mesh_data, GeometryInfo const& appended) -> void {
+    auto const attributes = attribute_views(appended);
+    auto const new_count  = static_cast<int>(appended.positions.size() / 3u);
+
+    if (new_count == 0) {
+        return;
     }
 
-    if (!geometry_info.texture_coordinates.empty()) {
-        update_attribute(geometry_info.texture_coordinates, GeneralShader::TextureCoordinate{});
+    if (mesh_data->vbo_count == 0) {
+        // Nothing to keep so the appended attributes decide the layout
+        for (auto a = 0u; a < attributes.size(); ++a) {
+            mesh_data->attribute_components[a] = attributes[a].empty() ? 0 : attribute_sizes[a];
+        }
+        mesh_data->vbo_capacity = 0;
     }
 
-    if (!geometry_info.vertex_colors.empty()) {
-        update_attribute(geometry_info.vertex_colors, GeneralShader::VertexColor{});
+    auto const count = mesh_data->vbo_count + new_count;
+
+    // Doubling the capacity keeps the cost of moving old vertices constant per appended vertex
+    if (count > mesh_data->vbo_capacity) {
+        grow_vbo(mesh_data, std::max(count, 2 * mesh_data->vbo_capacity));
     }
 
-    mesh_data->vertex_buffer.setData(buffer_data, GL::BufferUsage::StaticDraw);
-    mesh_data->mesh.setCount(mesh_data->vbo_count);
+    // Only the new tail of each attribute is uploaded
+    for (auto a = 0u; a < attributes.size(); ++a) {
+        auto const components = mesh_data->attribute_components[a];
+        if (components > 0) {
+            auto const tail_offset = static_cast<GLintptr>(components * mesh_data->vbo_count * sizeof(float));
+            mesh_data->vertex_buffer.setSubData(attribute_offset(*mesh_data, a, mesh_data->vbo_capacity) + tail_offset,
+                                                attributes[a]);
+        }
+    }
+
+    mesh_data->vbo_count = count;
+    if (mesh_data->ibo_count == 0) {
+        mesh_data->mesh.setCount(mesh_data->vbo_count);
+    }
 }
 
 auto update_ibo(MeshData* mesh_data, std::vector<unsigned> const& indices) {
     if (!indices.empty()) {
-        Corrade::Containers::Array<char> index_data;
-        MeshIndexType                    index_type;
-        std::tie(index_data, index_type) = MeshTools::compressIndices(indices);
-        mesh_data->index_buffer.setData(index_data, GL::BufferUsage::StaticDraw);
+        // Indices aren't compressed so more can be appended later without changing their type
+        mesh_data->index_buffer.setData(indices, GL::BufferUsage::StaticDraw);
+
+        mesh_data->ibo_count    = static_cast<int>(indices.size());
+        mesh_data->ibo_capacity = mesh_data->ibo_count;
+
+        mesh_data->mesh.setCount(mesh_data->ibo_count)
+            .setIndexBuffer(mesh_data->index_buffer, 0, MeshIndexType::UnsignedInt);
+    }
+}
+
+auto append_ibo(MeshData* mesh_data, std::vector<unsigned> const& indices) -> void {
+    if (indices.empty()) {
+        return;
+    }
+
+    auto const count = mesh_data->ibo_count + static_cast<int>(indices.size());
 
-        mesh_data->ibo_count = static_cast<int>(indices.size());
+    if (count > mesh_data->ibo_capacity) {
+        auto const capacity = std::max(count, 2 * mesh_data->ibo_capacity);
 
-        mesh_data->mesh.setCount(mesh_data->ibo_count).setIndexBuffer(mesh_data->index_buffer, 0, index_type);
+        GL::Buffer buffer;
+        buffer.setData({nullptr, static_cast<std::size_t>(capacity) * sizeof(unsigned)}, GL::BufferUsage::DynamicDraw);
+
+        if (mesh_data->ibo_count > 0) {
+            GL::Buffer::copy(mesh_data->index_buffer,
+                             buffer,
+                             0,
+                             0,
+                             static_cast<GLsizeiptr>(mesh_data->ibo_count * sizeof(unsigned)));
+        }
+
+        mesh_data->index_buffer = std::move(buffer);
+        mesh_data->ibo_capacity = capacity;
+        mesh_data->mesh.setIndexBuffer(mesh_data->index_buffer, 0, MeshIndexType::UnsignedInt);
     }
+
+    mesh_data->index_buffer.setSubData(static_cast<GLintptr>(mesh_data->ibo_count * sizeof(unsigned)), indices);
+
+    mesh_data->ibo_count = count;
+    mesh_data->mesh.setCount(mesh_data->ibo_count);
 }
 
 } // namespace
@@ -235,7 +359,7 @@ auto OpenglBackend::updated(SceneId const& item_id, UpdatedInfo const& updated,
             }
 
             if (updated.geometry_indices) {
-                update_ibo(mesh_data, geometry_info.indices);
+                update_ibo(mesh_data, geometry_info.indices.get());
             }
         }
 
@@ -286,6 +410,18 @@ auto OpenglBackend::updated(SceneId const& item_id, UpdatedInfo const& updated,
     }
 }
 
+auto OpenglBackend::appended(SceneId const& item_id, GeometryInfo const& appended) -> void {
+    OpenglItem& ogl_item = *id_to_pkgs_.at(item_id);
+
+    auto* mesh_data = std::get_if<MeshData>(&ogl_item.data);
+    if (!mesh_data) {
+        throw std::runtime_error("Geometry can not be appended when using a renderable");
+    }
+
+    append_vbo(mesh_data, appended);
+    append_ibo(mesh_data, appended.indices.get());
+}
+
 auto OpenglBackend::removed(SceneId const & /*item_id*/) -> void {}
 
 auto OpenglBackend::reset_items(SceneItems const& items) -> void {
@@ -43,6 +43,7 @@
 #include <Magnum/SceneGraph/SceneGraph.h>
 
 // standard
+#include <array>
 #include <list>
 #include <memory>
 #include <variant>
@@ -54,11 +55,17 @@ class OpenglRenderable;
 struct MeshData {
     explicit MeshData() = default;
 
+    /// \brief Each attribute has its own block of 'vbo_capacity' vertices in the vertex buffer
+    ///        so appending only writes to the end of each block
     Magnum::GL::Buffer vertex_buffer;
-    int                vbo_count = 0;
+    int                vbo_count            = 0;
+    int                vbo_capacity         = 0;
+    std::array<int, 4> attribute_components = {}; ///< Floats per vertex of positions, normals, texture
+                                                  ///< coordinates and colors. 0 if unused.
 
     Magnum::GL::Buffer index_buffer;
-    int                ibo_count = 0;
+    int                ibo_count    = 0;
+    int                ibo_capacity = 0;
 
     Magnum::GL::Mesh mesh;
 
@@ -75,6 +82,7 @@ public:
 
     auto added(SceneId const& item_id, SceneItemInfo const& item) -> void override;
     auto updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void override;
+    auto appended(SceneId const& item_id, GeometryInfo const& appended) -> void override;
     auto removed(SceneId const& item_id) -> void override;
 
     auto reset_items(SceneItems const& items) -> void override;
@@ -0,0 +1,86 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Geometry Visualization Server
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "batch_scene.hpp"
+
+// project
+#include "scene_core.hpp"
+
+namespace ltb::gvs {
+
+BatchScene::BatchScene(SceneCore& core_scene) : core_scene_(core_scene) {}
+
+BatchScene::~BatchScene() = default;
+
+auto BatchScene::item_ids() const -> std::unordered_set<SceneId> {
+    return core_scene_.item_ids();
+}
+
+auto BatchScene::clear() -> BatchScene& {
+    core_scene_.clear();
+    return *this;
+}
+
+auto BatchScene::set_seed(unsigned seed) -> BatchScene& {
+    core_scene_.set_seed(seed);
+    return *this;
+}
+
+auto BatchScene::actually_add_item(SparseSceneItemInfo&& info) -> util11::Result<SceneId> {
+    auto result = core_scene_.add_item(std::forward<SparseSceneItemInfo>(info));
+    if (!result) {
+        return util11::Error{result.error().error_message()};
+    }
+    return result.value();
+}
+
+auto BatchScene::actually_update_item(SceneId const& item_id, SparseSceneItemInfo&& info) -> util11::Error {
+    auto result = core_scene_.update_item(item_id, std::forward<SparseSceneItemInfo>(info));
+    if (!result) {
+        return util11::Error{result.error().error_message()};
+    }
+    return util11::success();
+}
+
+auto BatchScene::actually_append_to_item(SceneId const& item_id, SparseSceneItemInfo&& info) -> util11::Error {
+    auto result = core_scene_.append_to_item(item_id, std::forward<SparseSceneItemInfo>(info));
+    if (!result) {
+        return util11::Error{result.error().error_message()};
+    }
+    return util11::success();
+}
+
+auto BatchScene::actually_get_item_info(SceneId const& item_id, InfoGetterFunc info_getter) const -> util11::Error {
+    if (core_scene_.items().find(item_id) == core_scene_.items().end()) {
+        return util11::Error{"Item '" + gvs::to_string(item_id) + "' does not exist in the scene"};
+    }
+    info_getter(core_scene_.items().at(item_id));
+    return util11::success();
+}
+
+auto BatchScene::actually_batch(SceneBatchFunc const& func) -> util11::Error {
+    // Already part of a batch
+    func(*this);
+    return util11::success();
+}
+
+} // namespace ltb::gvs
@@ -23,7 +23,9 @@
 #include "display_scene.hpp"
 
 // project
+#include "batch_scene.hpp"
 #include "display_window.hpp"
+#include "ltb/util/generic_guard.hpp"
 
 namespace ltb::gvs {
 
@@ -107,22 +109,69 @@ auto DisplayScene::actually_get_item_info(SceneId const& item_id, InfoGetterFunc
     });
 }
 
+auto DisplayScene::actually_batch(SceneBatchFunc const& func) -> util11::Error {
+    return core_scene_->use_safely([this, &func](SceneCore& core_scene) {
+        batch_ = std::make_unique<SceneUpdateBatch>();
+
+        auto finish_batch = [this] {
+            auto batch = std::move(batch_); // Leaves 'batch_' null so notifications are sent normally again
+
+            if (!batch->empty()) {
+                display_window_->thread_safe_update([&batch](SceneUpdateHandler* handler) { batch->replay(handler); });
+            }
+        };
+
+        // Send everything that changed as one update, even if 'func' throws part way through
+        auto batch_guard = util::make_guard([] {}, finish_batch);
+
+        BatchScene batch_scene(core_scene);
+        func(batch_scene);
+        return util11::success();
+    });
+}
+
+// Updates are merged into the display window's queue, which keeps the latest data for each item.
+// Geometry is held in SharedBuffers so keeping it only shares pointers, however many vertices an item has.
+
 auto DisplayScene::added(SceneId const& item_id, SceneItemInfo const& item) -> void {
-    display_window_->thread_safe_update(
-        [item_id, item](SceneUpdateHandler* handler) { handler->added(item_id, item); });
+    if (batch_) {
+        batch_->added(item_id, item);
+        return;
+    }
+    display_window_->thread_safe_update([&](SceneUpdateHandler* handler) { handler->added(item_id, item); });
 }
 
 auto DisplayScene::updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) -> void {
+    if (batch_) {
+        batch_->updated(item_id, updated, item);
+        return;
+    }
     display_window_->thread_safe_update(
-        [item_id, updated, item](SceneUpdateHandler* handler) { handler->updated(item_id, updated, item); });
+        [&](SceneUpdateHandler* handler) { handler->updated(item_id, updated, item); });
+}
+
+auto DisplayScene::appended(SceneId const& item_id, GeometryInfo const& appended) -> void {
+    if (batch_) {
+        batch_->appended(item_id, appended);
+        return;
+    }
+    display_window_->thread_safe_update([&](SceneUpdateHandler* handler) { handler->appended(item_id, appended); });
 }
 
 auto DisplayScene::removed(SceneId const& item_id) -> void {
-    display_window_->thread_safe_update([item_id](SceneUpdateHandler* handler) { handler->removed(item_id); });
+    if (batch_) {
+        batch_->removed(item_id);
+        return;
+    }
+    display_window_->thread_safe_update([&](SceneUpdateHandler* handler) { handler->removed(item_id); });
 }
 
 auto DisplayScene::reset_items(SceneItems const& items) -> void {
-    display_window_->thread_safe_update([items](SceneUpdateHandler* handler) { handler->reset_items(items); });
+    if (batch_) {
+        batch_->reset_items(items);
+        return;
+    }
+    display_window_->thread_safe_update([&](SceneUpdateHandler* handler) { handler->reset_items(items); });
 }
 
 } // namespace ltb::gvs
@@ -25,6 +25,7 @@
 // project
 #include "display_window.hpp"
 #include "ltb/gvs/core/scene.hpp"
+#include "ltb/gvs/core/scene_update_batch.hpp"
 #include "ltb/gvs/core/scene_update_handler.hpp"
 #include "ltb/util/atomic_data.hpp"
 #include "scene_core.hpp"
@@ -56,6 +57,8 @@ public:
 
     [[nodiscard]] auto actually_get_item_info(SceneId const& item_id, InfoGetterFunc info_getter) const
         -> util11::Error override;
+
+    auto actually_batch(SceneBatchFunc const& func) -> util11::Error override;
     /*
      * End `Scene` functions
      */
@@ -66,6 +69,7 @@ private:
      */
     void added(SceneId const& item_id, SceneItemInfo const& item) override;
     void updated(SceneId const& item_id, UpdatedInfo const& updated, SceneItemInfo const& item) override;
+    void appended(SceneId const& item_id, GeometryInfo const& appended) override;
     void removed(SceneId const& item_id) override;
     void reset_items(SceneItems const& items) override;
     /*
@@ -74,6 +78,7 @@ private:
 
     std::unique_ptr<ltb::gvs::DisplayWindow>     display_window_{}; ///< Used to display the scene in a window
     std::unique_ptr<util::AtomicData<SceneCore>> core_scene_; ///< Handles all the scene logic
+    std::unique_ptr<SceneUpdateBatch>            batch_{}; ///< Collects notifications during `batch`
 
     std::thread display_thread_; ///< Runs the display window
 };
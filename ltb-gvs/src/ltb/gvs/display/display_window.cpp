@@ -36,6 +36,7 @@
 #include <imgui.h>
 
 // standard
+#include <chrono>
 #include <limits>
 
 using namespace Magnum;
@@ -56,29 +57,41 @@ DisplayWindow::DisplayWindow(DisplayScene& parent_scene)
                                  .setSize({1280, 720})
                                  .setWindowFlags(Configuration::WindowFlag::Resizable)),
       parent_scene_(parent_scene),
-      scene_backend_(std::make_unique<OpenglBackend>()) {}
+      scene_backend_(std::make_unique<OpenglBackend>()),
+      queued_updates_(std::make_unique<SceneUpdateBatch>()),
+      pending_updates_(std::make_unique<SceneUpdateBatch>()) {}
 
 DisplayWindow::~DisplayWindow() = default;
 
-auto DisplayWindow::thread_safe_update(SceneUpdateFunc update_func) -> void {
+auto DisplayWindow::thread_safe_update(SceneUpdateFunc const& update_func) -> void {
     std::lock_guard lock(update_lock_);
-    update_functions_.emplace_back(std::move(update_func));
+    update_func(queued_updates_.get());
     this->reset_draw_counter();
 }
 
 void DisplayWindow::update() {
-    std::lock_guard lock(update_lock_);
+    // Roughly half a frame at 60Hz so large scene loads appear within a few frames without freezing the window
+    constexpr auto update_time_budget = std::chrono::milliseconds(8);
+    auto const     deadline           = std::chrono::steady_clock::now() + update_time_budget;
+
+    // Take every queued update at once so scenes are not blocked while the backend processes them
+    auto queued_updates = std::make_unique<SceneUpdateBatch>();
+    {
+        std::lock_guard lock(update_lock_);
+        std::swap(queued_updates, queued_updates_);
+    }
 
-    // Process an update
-    constexpr auto max_updates_per_step = 10u;
-    for (auto update = 0u; !update_functions_.empty() && update < max_updates_per_step; ++update) {
-        auto update_func = std::move(update_functions_.front());
-        update_functions_.pop_front();
-        update_func(scene_backend_.get());
+    if (pending_updates_->empty()) {
+        std::swap(queued_updates, pending_updates_);
+    } else {
+        // Merge with the updates left over from the last frame
+        queued_updates->replay(pending_updates_.get());
     }
 
+    auto const finished = pending_updates_->replay_until(scene_backend_.get(), deadline);
+
     // Trigger another update if more updates are needed still
-    if (!update_functions_.empty()) {
+    if (!finished) {
         this->reset_draw_counter();
     }
 }
@@ -24,6 +24,7 @@
 
 #include "forward_declarations.hpp"
 #include "gui/imgui_magnum_application.hpp"
+#include "ltb/gvs/core/scene_update_batch.hpp"
 #include "ltb/util/blocking_queue.hpp"
 #include "scene_update_func.hpp"
 
@@ -37,7 +38,10 @@ public:
     explicit DisplayWindow(DisplayScene& parent_scene);
     ~DisplayWindow() override;
 
-    auto thread_safe_update(SceneUpdateFunc update_func) -> void;
+    /// \brief Calls 'update_func' with a handler that queues the update for the backend.
+    ///        Updates to the same item are merged while they wait, so 'update_func' is called
+    ///        before this function returns and doesn't need to copy anything it uses.
+    auto thread_safe_update(SceneUpdateFunc const& update_func) -> void;
 
 private:
     void update() override;
@@ -51,8 +55,9 @@ private:
     std::unique_ptr<DisplayBackend> scene_backend_; ///< Used to update and display the scene
 
     // Data processing
-    std::mutex                  update_lock_;
-    std::deque<SceneUpdateFunc> update_functions_;
+    std::mutex                        update_lock_;
+    std::unique_ptr<SceneUpdateBatch> queued_updates_; ///< Updates from other threads, guarded by 'update_lock_'
+    std::unique_ptr<SceneUpdateBatch> pending_updates_; ///< Merged updates not yet sent to the backend
 };
 
 } // namespace ltb::gvs
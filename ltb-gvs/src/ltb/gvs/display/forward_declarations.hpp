@@ -28,6 +28,7 @@ class LocalScene;
 class SceneDisplay;
 class SceneCore;
 class DisplayScene;
+class BatchScene;
 class DisplayWindow;
 
 // gui
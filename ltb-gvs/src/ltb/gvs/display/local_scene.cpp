@@ -111,4 +111,10 @@ auto LocalScene::actually_get_item_info(const gvs::SceneId& item_id, InfoGetterF
     return util11::success();
 }
 
+auto LocalScene::actually_batch(SceneBatchFunc const& func) -> util11::Error {
+    // Changes already go straight to the backend on this thread so there is nothing to batch
+    func(*this);
+    return util11::success();
+}
+
 } // namespace ltb::gvs
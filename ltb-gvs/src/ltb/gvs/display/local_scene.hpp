@@ -62,6 +62,8 @@ private:
 
     [[nodiscard]] auto actually_get_item_info(SceneId const& item_id, InfoGetterFunc info_getter) const
         -> util11::Error override;
+
+    auto actually_batch(SceneBatchFunc const& func) -> util11::Error override;
     /*
      * End `Scene` functions
      */
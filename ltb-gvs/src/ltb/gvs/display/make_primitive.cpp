@@ -40,25 +40,26 @@
 namespace ltb::gvs {
 namespace {
 
-auto extract_positions_normal_indices(const Magnum::Trade::MeshData& mesh,
-                                      AttributeVector<3>*            positions_out,
-                                      AttributeVector<3>*            normals_out,
-                                      std::vector<unsigned>*         indices_out) {
+auto extract_positions_normal_indices(const Magnum::Trade::MeshData&       mesh,
+                                      SharedBuffer<AttributeVector<3>>*    positions_out,
+                                      SharedBuffer<AttributeVector<3>>*    normals_out,
+                                      SharedBuffer<std::vector<unsigned>>* indices_out) {
     if (positions_out) {
         auto positions = std::vector<Magnum::Vector3>(mesh.vertexCount());
         mesh.positions3DInto(positions);
-        *positions_out = std::move(positions);
+        *positions_out = AttributeVector<3>(std::move(positions));
     }
 
     if (normals_out) {
         auto normals = std::vector<Magnum::Vector3>(mesh.vertexCount());
         mesh.normalsInto(normals);
-        *normals_out = std::move(normals);
+        *normals_out = AttributeVector<3>(std::move(normals));
     }
 
     if (indices_out) {
-        indices_out->resize(mesh.indexCount());
-        mesh.indicesInto(*indices_out);
+        auto indices = std::vector<unsigned>(mesh.indexCount());
+        mesh.indicesInto(indices);
+        *indices_out = std::move(indices);
     }
 }
 
@@ -76,7 +77,7 @@ struct PrimitiveVisitor {
 
         info->geometry_info = {};
         extract_positions_normal_indices(mesh, &info->geometry_info.positions, nullptr, &info->geometry_info.indices);
-        info->geometry_info.vertex_colors  = std::move(colors);
+        info->geometry_info.vertex_colors  = AttributeVector<3>(std::move(colors));
         info->display_info.geometry_format = from_magnum(mesh.primitive());
         info->display_info.coloring        = gvs::Coloring::VertexColors;
         info->display_info.shading         = gvs::Shading::UniformColor;
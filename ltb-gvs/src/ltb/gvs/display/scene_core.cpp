@@ -86,8 +86,29 @@ auto SceneCore::update_item(SceneId const& item_id, SparseSceneItemInfo&& info)
     return util::success();
 }
 
-auto SceneCore::append_to_item(SceneId const& /*item_id*/, SparseSceneItemInfo && /*info*/) -> util::Result<void> {
-    throw std::runtime_error(__FUNCTION__ + std::string(" not yet implemented"));
+auto SceneCore::append_to_item(SceneId const& item_id, SparseSceneItemInfo&& info) -> util::Result<void> {
+    auto& item = items_.at(item_id);
+
+    if (info.geometry) {
+        if (!info.geometry->is<SparseGeometryInfo>() || item.renderable) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Only vertex geometry can be appended to an item"));
+        }
+
+        auto appended = append_if_present(&item, std::move(info.geometry->get<SparseGeometryInfo>()));
+        if (!appended) {
+            return tl::make_unexpected(appended.error());
+        }
+        info.geometry = nullptr;
+
+        // Only the appended geometry is passed on so handlers can upload it without touching the rest
+        update_handler_.appended(item_id, appended.value());
+    }
+
+    // Everything else replaces the existing info
+    if (info.display_info || info.parent || info.children) {
+        return update_item(item_id, std::move(info));
+    }
+    return util::success();
 }
 
 auto SceneCore::set_seed(std::random_device::result_type seed) -> SceneCore& {
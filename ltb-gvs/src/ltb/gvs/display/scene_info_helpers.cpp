@@ -25,6 +25,9 @@
 // project
 #include "make_primitive.hpp"
 
+// external
+#include <doctest/doctest.h>
+
 namespace ltb::gvs {
 
 auto replace_if_present(SceneItemInfo* info, SparseSceneItemInfo&& new_info) -> util::Result<void> {
@@ -115,4 +118,134 @@ auto replace_if_present(SceneItemInfo* info, SparseSceneItemInfo&& new_info) ->
     return util::success();
 }
 
+auto append_if_present(SceneItemInfo* info, SparseGeometryInfo&& new_geometry) -> util::Result<GeometryInfo> {
+    auto& geometry_info = info->geometry_info;
+
+    auto const vertex_count     = geometry_info.positions.size() / 3ul;
+    auto const new_vertex_count = (new_geometry.positions ? new_geometry.positions->size() / 3ul : 0ul);
+
+    // Everything is checked before anything is appended so errors leave the item unchanged
+    auto check_size = [vertex_count, new_vertex_count](auto const&        data,
+                                                       auto const&        new_data,
+                                                       std::size_t        element_size,
+                                                       std::string const& name) -> util::Result<void> {
+        // Appended attributes can only describe appended vertices. Filling in an attribute for the
+        // existing vertices would require re-uploading the whole item instead of just the new tail.
+        if (new_data && new_data->size() / element_size != new_vertex_count) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("appended positions.size() != appended " + name + ".size()"));
+        }
+
+        auto const size = data.size() + (new_data ? new_data->size() : 0ul);
+
+        if (size != 0ul && size / element_size != vertex_count + new_vertex_count) {
+            return tl::make_unexpected(
+                LTB_MAKE_ERROR(name + " is non-empty and positions.size() != " + name + ".size() after appending"));
+        }
+        return util::success();
+    };
+
+    auto result = check_size(geometry_info.normals, new_geometry.normals, 3ul, "normals")
+                      .and_then(check_size,
+                                geometry_info.texture_coordinates,
+                                new_geometry.texture_coordinates,
+                                2ul,
+                                "texture_coordinates")
+                      .and_then(check_size,
+                                geometry_info.vertex_colors,
+                                new_geometry.vertex_colors,
+                                3ul,
+                                "vertex_colors");
+
+    if (!result) {
+        return tl::make_unexpected(result.error());
+    }
+
+    GeometryInfo appended;
+
+    auto maybe_append = [](auto& data, auto& appended_data, auto&& new_data) {
+        if (new_data) {
+            appended_data = std::move(*(new_data));
+            data.modify([&appended_data](auto& values) { values.append(appended_data.get()); });
+        }
+    };
+
+    maybe_append(geometry_info.positions, appended.positions, std::move(new_geometry.positions));
+    maybe_append(geometry_info.normals, appended.normals, std::move(new_geometry.normals));
+    maybe_append(geometry_info.texture_coordinates,
+                 appended.texture_coordinates,
+                 std::move(new_geometry.texture_coordinates));
+    maybe_append(geometry_info.vertex_colors, appended.vertex_colors, std::move(new_geometry.vertex_colors));
+
+    if (new_geometry.indices) {
+        auto indices = std::move(*new_geometry.indices);
+
+        if (new_vertex_count > 0ul) {
+            for (auto& index : indices) {
+                index += static_cast<unsigned>(vertex_count);
+            }
+        }
+
+        geometry_info.indices.modify(
+            [&indices](auto& values) { values.insert(values.end(), indices.begin(), indices.end()); });
+        appended.indices = std::move(indices);
+    }
+
+    return appended;
+}
+
+namespace {
+
+auto make_points(std::size_t vertex_count) -> SceneItemInfo {
+    SceneItemInfo info;
+    info.geometry_info.positions = AttributeVector<3>(std::vector<float>(vertex_count * 3ul, 1.f));
+    return info;
+}
+
+auto make_floats(std::size_t size) -> std::unique_ptr<AttributeVector<3>> {
+    return std::make_unique<AttributeVector<3>>(std::vector<float>(size, 0.5f));
+}
+
+} // namespace
+
+TEST_CASE("[ltb][gvs] append_if_present appends vertices and offsets indices") {
+    auto info = make_points(10);
+
+    SparseGeometryInfo geometry;
+    geometry.positions = make_floats(6);
+    geometry.indices   = std::make_unique<std::vector<unsigned>>(std::vector<unsigned>{0u, 1u});
+
+    auto appended = append_if_present(&info, std::move(geometry));
+    REQUIRE(appended);
+
+    CHECK(info.geometry_info.positions.size() == 36ul);
+    CHECK(appended->positions.size() == 6ul);
+    CHECK(info.geometry_info.indices.get() == std::vector<unsigned>{10u, 11u});
+    CHECK(appended->indices.get() == std::vector<unsigned>{10u, 11u});
+}
+
+TEST_CASE("[ltb][gvs] append_if_present rejects attributes for existing vertices") {
+    auto info = make_points(10);
+
+    SUBCASE("without appended positions") {
+        // 10 normals would match the item's vertex count but there are no appended vertices to upload them with
+        SparseGeometryInfo geometry;
+        geometry.normals = make_floats(30);
+
+        CHECK_FALSE(append_if_present(&info, std::move(geometry)));
+    }
+
+    SUBCASE("with appended positions") {
+        // 20 normals for 10 old + 10 new vertices
+        SparseGeometryInfo geometry;
+        geometry.positions = make_floats(30);
+        geometry.normals   = make_floats(60);
+
+        CHECK_FALSE(append_if_present(&info, std::move(geometry)));
+    }
+
+    // Errors leave the item unchanged
+    CHECK(info.geometry_info.positions.size() == 30ul);
+    CHECK(info.geometry_info.normals.empty());
+}
+
 } // namespace ltb::gvs
@@ -30,4 +30,9 @@ namespace ltb::gvs {
 
 auto replace_if_present(SceneItemInfo* info, SparseSceneItemInfo&& new_info) -> util::Result<void>;
 
+/// \brief Appends 'new_geometry' to the item's geometry and returns only the appended part.
+///        Appended indices are offset to index the appended vertices if positions were appended too.
+///        The item is unchanged if an error is returned.
+auto append_if_present(SceneItemInfo* info, SparseGeometryInfo&& new_geometry) -> util::Result<GeometryInfo>;
+
 } // namespace ltb::gvs
@@ -0,0 +1,131 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "arena.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <cstdint>
+
+namespace ltb::ddf {
+namespace {
+
+auto padding_for(void const* ptr, std::size_t alignment) -> std::size_t {
+    auto const address = reinterpret_cast<std::uintptr_t>(ptr);
+    return (alignment - (address % alignment)) % alignment;
+}
+
+} // namespace
+
+Arena::Arena(std::size_t chunk_size) : chunk_size_(std::max(chunk_size, std::size_t{64u})) {}
+
+Arena::~Arena() = default;
+
+auto Arena::allocate(std::size_t size, std::size_t alignment) -> void* {
+    size = std::max(size, std::size_t{1u});
+
+    // Walk forward through the existing chunks (kept from before a reset) before growing.
+    while (current_chunk_ < chunks_.size()) {
+        auto& chunk   = chunks_[current_chunk_];
+        auto* cursor  = chunk.memory.get() + offset_;
+        auto  padding = padding_for(cursor, alignment);
+
+        if (offset_ + padding + size <= chunk.size) {
+            offset_ += padding + size;
+            used_ += padding + size;
+            return cursor + padding;
+        }
+
+        ++current_chunk_;
+        offset_ = 0u;
+    }
+
+    auto const chunk_size = std::max(chunk_size_, size + alignment);
+    chunks_.push_back({std::make_unique<std::byte[]>(chunk_size), chunk_size});
+
+    current_chunk_ = chunks_.size() - 1u;
+    offset_        = 0u;
+    return allocate(size, alignment);
+}
+
+auto Arena::reset() -> void {
+    current_chunk_ = 0u;
+    offset_        = 0u;
+    used_          = 0u;
+}
+
+auto Arena::bytes_used() const -> std::size_t {
+    return used_;
+}
+
+auto Arena::bytes_reserved() const -> std::size_t {
+    auto total = std::size_t{0u};
+    for (auto const& chunk : chunks_) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+TEST_CASE("[ltb][ddf] arena allocations are aligned and reused after reset") {
+    Arena arena(256u);
+
+    auto* a = arena.allocate(3u, 1u);
+    auto* b = arena.allocate(8u, 8u);
+    auto* c = arena.allocate(16u, 64u);
+
+    CHECK(reinterpret_cast<std::uintptr_t>(b) % 8u == 0u);
+    CHECK(reinterpret_cast<std::uintptr_t>(c) % 64u == 0u);
+    CHECK(a != b);
+
+    // Larger than a chunk
+    auto* big = arena.allocate(1000u, 16u);
+    CHECK(reinterpret_cast<std::uintptr_t>(big) % 16u == 0u);
+
+    auto const reserved = arena.bytes_reserved();
+    arena.reset();
+    CHECK(arena.bytes_used() == 0u);
+
+    // The same pattern of allocations fits in the existing chunks
+    arena.allocate(3u, 1u);
+    arena.allocate(8u, 8u);
+    arena.allocate(16u, 64u);
+    arena.allocate(1000u, 16u);
+    CHECK(arena.bytes_reserved() == reserved);
+}
+
+TEST_CASE("[ltb][ddf] arena allocator in standard containers") {
+    Arena arena;
+
+    std::vector<int, ArenaAllocator<int>> values(arena);
+    for (auto i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+
+    CHECK(values.size() == 1000u);
+    CHECK(values.back() == 999);
+    CHECK(arena.bytes_used() >= 1000u * sizeof(int));
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,118 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace ltb::ddf {
+
+/**
+ * @brief A chunked bump allocator.
+ *
+ * Allocations are carved out of large chunks and never freed individually. 'reset'
+ * rewinds to the first chunk while keeping every chunk around, so an arena that is reset
+ * each tick stops touching the system allocator once it has grown to its working size.
+ * Nothing allocated from an arena is destroyed by it: callers are responsible for running
+ * destructors of non-trivial objects before the memory is reset or released.
+ */
+class Arena {
+public:
+    explicit Arena(std::size_t chunk_size = 64u * 1024u);
+    ~Arena();
+
+    Arena(Arena const&) = delete;
+    Arena(Arena&&)      = delete;
+    auto operator=(Arena const&) -> Arena& = delete;
+    auto operator=(Arena&&) -> Arena& = delete;
+
+    /// \brief Returns 'size' bytes aligned to 'alignment' (which must be a power of two)
+    auto allocate(std::size_t size, std::size_t alignment) -> void*;
+
+    /// \brief Allocates uninitialized storage for 'count' values of T
+    template <typename T>
+    auto allocate_array(std::size_t count) -> T* {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /// \brief Makes all memory available again without returning chunks to the system
+    auto reset() -> void;
+
+    /// \brief The number of bytes handed out since the last reset (including alignment padding)
+    auto bytes_used() const -> std::size_t;
+
+    /// \brief The total size of every chunk owned by the arena
+    auto bytes_reserved() const -> std::size_t;
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t                  size;
+    };
+
+    std::size_t        chunk_size_; ///< The minimum size of each new chunk
+    std::vector<Chunk> chunks_; ///< Every chunk allocated so far
+    std::size_t        current_chunk_ = 0u; ///< The chunk allocations are currently served from
+    std::size_t        offset_        = 0u; ///< The next free byte in the current chunk
+    std::size_t        used_          = 0u; ///< Bytes handed out since the last reset
+};
+
+/**
+ * @brief A standard allocator backed by an Arena, for containers used as per-tick temporaries.
+ *
+ *     auto& scratch = ctx.scratch();
+ *     std::vector<float, ltb::ddf::ArenaAllocator<float>> samples(scratch);
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena& arena) : arena_(&arena) {} // NOLINT(google-explicit-constructor)
+
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) : arena_(other.arena()) {} // NOLINT(google-explicit-constructor)
+
+    auto allocate(std::size_t count) -> T* { return arena_->allocate_array<T>(count); }
+    auto deallocate(T*, std::size_t) -> void {}
+
+    auto arena() const -> Arena* { return arena_; }
+
+    template <typename U>
+    auto operator==(ArenaAllocator<U> const& other) const -> bool {
+        return arena_ == other.arena();
+    }
+
+    template <typename U>
+    auto operator!=(ArenaAllocator<U> const& other) const -> bool {
+        return arena_ != other.arena();
+    }
+
+private:
+    Arena* arena_;
+};
+
+} // namespace ltb::ddf
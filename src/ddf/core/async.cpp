@@ -0,0 +1,106 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "async.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <string>
+#include <thread>
+
+TEST_CASE("[ltb][ddf] async values") {
+    using namespace ltb;
+
+    SUBCASE("ready") {
+        auto async = ddf::Async<int>::ready(3);
+        CHECK(async.valid());
+        REQUIRE(async.poll());
+        CHECK(async.take() == 3);
+        CHECK_FALSE(async.valid());
+        CHECK_THROWS(async.take());
+    }
+
+    SUBCASE("empty") {
+        auto async = ddf::Async<int>();
+        CHECK_FALSE(async.valid());
+        CHECK_FALSE(async.poll());
+    }
+
+    SUBCASE("future") {
+        auto promise = std::promise<std::string>();
+        auto async   = ddf::Async<std::string>::from_future(promise.get_future());
+
+        CHECK_FALSE(async.poll());
+        promise.set_value("done");
+        REQUIRE(async.poll());
+        CHECK(async.take() == "done");
+    }
+
+    SUBCASE("future exception") {
+        auto promise = std::promise<int>();
+        auto async   = ddf::Async<int>::from_future(promise.get_future());
+
+        promise.set_exception(std::make_exception_ptr(std::runtime_error("failed")));
+        CHECK_THROWS_AS(async.poll(), std::runtime_error);
+    }
+
+    SUBCASE("timer") {
+        auto async = ddf::Async<int>::after(std::chrono::milliseconds(5), 7);
+        CHECK_FALSE(async.poll());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE(async.poll());
+        CHECK(async.take() == 7);
+    }
+
+    SUBCASE("continuations") {
+        auto first  = std::promise<int>();
+        auto second = std::promise<int>();
+        auto calls  = 0;
+
+        auto async = ddf::Async<int>::from_future(first.get_future())
+                         .then([&](int x) {
+                             ++calls;
+                             return ddf::Async<int>::from_future(second.get_future()).then([x](int y) {
+                                 return x + y;
+                             });
+                         })
+                         .then([&calls](int sum) { return ++calls, std::to_string(sum); });
+
+        CHECK_FALSE(async.poll());
+
+        first.set_value(1);
+        CHECK_FALSE(async.poll());
+        CHECK(calls == 1);
+
+        // The first continuation is not called again while waiting on the second future
+        CHECK_FALSE(async.poll());
+        CHECK(calls == 1);
+
+        second.set_value(2);
+        REQUIRE(async.poll());
+        CHECK(calls == 2);
+        CHECK(async.take() == "3");
+    }
+}
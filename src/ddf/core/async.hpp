@@ -0,0 +1,204 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ltb::ddf {
+
+template <typename T>
+class Async;
+
+namespace detail {
+
+template <typename T>
+struct is_async : std::false_type {};
+
+template <typename T>
+struct is_async<Async<T>> : std::true_type {};
+
+template <typename T>
+struct async_value {
+    using type = T;
+};
+
+template <typename T>
+struct async_value<Async<T>> {
+    using type = T;
+};
+
+/// \brief The value type of the Async returned by 'Async<T>::then(func)'
+template <typename T, typename Func>
+using continuation_value_t = typename async_value<std::decay_t<std::invoke_result_t<Func&, T>>>::type;
+
+} // namespace detail
+
+/**
+ * @brief A result that becomes available later without anyone blocking on it.
+ *
+ * An Async is polled rather than waited on: 'poll' returns true once the value is ready and
+ * 'take' then moves it out. Async node bodies (see 'ddf::add_async_transform') return one
+ * and the graph polls it once per tick, so a single worker interleaves any number of nodes
+ * that are waiting on I/O, timers, or work running elsewhere.
+ *
+ * 'then' chains a continuation that runs once the value is ready. It can return a plain
+ * value or another Async, so a multi-step operation reads top to bottom:
+ *
+ *     return Async<Request>::from_future(std::async(std::launch::async, fetch, id))
+ *         .then([](Request request) { return Async<Image>::from_future(decode(request)); })
+ *         .then([](Image image) { return thumbnail(image); });
+ */
+template <typename T>
+class Async {
+public:
+    static_assert(!std::is_void_v<T>, "Async values must not be void");
+
+    using value_type = T;
+    using Poll       = std::function<std::optional<T>()>;
+
+    /// \brief An empty Async that never becomes ready
+    Async() = default;
+
+    /// \brief Calls 'poll' until it returns a value
+    explicit Async(Poll poll) : poll_(std::move(poll)) {}
+
+    /// \brief An Async that is ready immediately
+    static auto ready(T value) -> Async;
+
+    /// \brief Ready once 'future' is. An exception stored in the future is rethrown by 'poll'.
+    static auto from_future(std::future<T> future) -> Async;
+
+    /// \brief Ready with 'value' once 'delay' has passed
+    static auto after(std::chrono::steady_clock::duration delay, T value) -> Async;
+
+    /// \brief Checks for the value without blocking. Returns true once it is ready.
+    auto poll() -> bool;
+
+    /// \brief Moves the value out. 'poll' must have returned true.
+    auto take() -> T;
+
+    /// \brief True unless this Async is empty or its value was taken
+    auto valid() const -> bool { return static_cast<bool>(poll_) || result_.has_value(); }
+
+    /// \brief Calls 'func(value)' once the value is ready. 'func' may return a value or an Async.
+    template <typename Func>
+    auto then(Func&& func) && -> Async<detail::continuation_value_t<T, Func>>;
+
+private:
+    Poll             poll_;
+    std::optional<T> result_;
+};
+
+template <typename T>
+auto Async<T>::ready(T value) -> Async {
+    auto async    = Async();
+    async.result_ = std::move(value);
+    return async;
+}
+
+template <typename T>
+auto Async<T>::from_future(std::future<T> future) -> Async {
+    // std::function needs a copyable callable
+    auto shared = std::make_shared<std::future<T>>(std::move(future));
+
+    return Async([shared]() -> std::optional<T> {
+        if (shared->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return std::nullopt;
+        }
+        return shared->get();
+    });
+}
+
+template <typename T>
+auto Async<T>::after(std::chrono::steady_clock::duration delay, T value) -> Async {
+    auto const deadline = std::chrono::steady_clock::now() + delay;
+
+    return Async([deadline, value = std::move(value)]() -> std::optional<T> {
+        if (std::chrono::steady_clock::now() < deadline) {
+            return std::nullopt;
+        }
+        return value;
+    });
+}
+
+template <typename T>
+auto Async<T>::poll() -> bool {
+    if (!result_ && poll_) {
+        result_ = poll_();
+        if (result_) {
+            poll_ = nullptr;
+        }
+    }
+    return result_.has_value();
+}
+
+template <typename T>
+auto Async<T>::take() -> T {
+    if (!result_) {
+        throw std::logic_error("Async value taken before it was ready");
+    }
+    auto value = std::move(*result_);
+    result_.reset();
+    return value;
+}
+
+template <typename T>
+template <typename Func>
+auto Async<T>::then(Func&& func) && -> Async<detail::continuation_value_t<T, Func>> {
+    using Result = std::decay_t<std::invoke_result_t<Func&, T>>;
+    using U      = detail::continuation_value_t<T, Func>;
+
+    struct State {
+        Async<T>                first;
+        std::decay_t<Func>      func;
+        std::optional<Async<U>> second;
+    };
+    auto state = std::make_shared<State>(State{std::move(*this), std::forward<Func>(func), std::nullopt});
+
+    return Async<U>([state]() -> std::optional<U> {
+        if (!state->second) {
+            if (!state->first.poll()) {
+                return std::nullopt;
+            }
+            if constexpr (detail::is_async<Result>::value) {
+                state->second = state->func(state->first.take());
+            } else {
+                return state->func(state->first.take());
+            }
+        }
+        if (!state->second->poll()) {
+            return std::nullopt;
+        }
+        return state->second->take();
+    });
+}
+
+} // namespace ltb::ddf
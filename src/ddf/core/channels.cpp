@@ -0,0 +1,148 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "channels.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+namespace ltb::ddf {
+
+TEST_CASE("[ltb][ddf] channels between graphs ticked on different threads") {
+    constexpr auto count = 5000;
+
+    ddf region_a;
+    ddf region_b;
+
+    auto counter = region_a.add_source("counter", [i = 0]() mutable { return ++i; });
+
+    auto latest = add_state_channel(region_a, counter, region_b, "latest");
+    auto events = add_event_channel(region_a, counter, region_b, "events", 8192u);
+
+    auto latest_seen  = 0;
+    auto monotonic    = true;
+    auto events_total = 0l;
+    auto events_count = 0;
+
+    region_b.add_sink(
+        "check latest",
+        [&](int value) {
+            monotonic &= (value >= latest_seen);
+            latest_seen = value;
+        },
+        latest);
+
+    region_b.add_event_sink(
+        "sum events",
+        [&](Span<int const> values) {
+            for (auto value : values) {
+                events_total += value;
+                ++events_count;
+            }
+        },
+        events.received);
+
+    REQUIRE(region_a.compile());
+    REQUIRE(region_b.compile());
+
+    std::atomic_bool producer_done{false};
+
+    std::thread producer([&] {
+        for (auto i = 0; i < count; ++i) {
+            region_a.tick();
+        }
+        producer_done = true;
+    });
+
+    while (!producer_done || events.queue->size() > 0u) {
+        region_b.tick();
+    }
+    region_b.tick();
+    producer.join();
+
+    CHECK(monotonic);
+    CHECK(latest_seen == count);
+    CHECK(events_count == count);
+    CHECK(events_total == static_cast<long>(count) * (count + 1) / 2);
+    CHECK(events.queue->dropped() == 0u);
+}
+
+TEST_CASE("[ltb][ddf] profiling records node times, tick timing and channel queue depths") {
+    ddf region_a;
+    ddf region_b;
+
+    auto counter = region_a.add_source("counter", [i = 0]() mutable { return ++i; });
+    auto events  = add_event_channel(region_a, counter, region_b, "events");
+    region_b.add_event_sink("drain", [](Span<int const>) {}, events.received);
+
+    region_b.enable_profiling(16u);
+
+    REQUIRE(region_a.compile());
+    REQUIRE(region_b.compile());
+
+    if (!profiling_enabled) {
+        CHECK(region_b.profiler() == nullptr);
+        return;
+    }
+    REQUIRE(region_b.profiler() != nullptr);
+    CHECK(region_a.profiler() == nullptr);
+
+    // Three events are queued before the consumer ticks
+    for (auto i = 0; i < 3; ++i) {
+        region_a.tick();
+    }
+    region_b.tick();
+    region_b.tick();
+    region_b.tick();
+
+    auto const& profiler = *region_b.profiler();
+    CHECK(profiler.ticks().duration_ns.count() == 3u);
+    CHECK(profiler.ticks().period_ns.count() == 2u);
+    CHECK(profiler.ticks().jitter_ns.count() == 1u);
+
+    for (auto n = 0u; n < region_b.node_count(); ++n) {
+        CHECK(profiler.node(n).execution_ns.count() == 3u);
+    }
+
+    REQUIRE(profiler.edges().size() == 1u);
+    CHECK(profiler.edges()[0].name == "events");
+    CHECK(profiler.edges()[0].queue_depth.count() == 3u);
+    CHECK(profiler.edges()[0].queue_depth.max() == 3u);
+    CHECK(profiler.edges()[0].dropped == 0u);
+
+    CHECK(profiler.trace().size() == 3u * region_b.node_count());
+
+    std::stringstream stream;
+    region_b.write_profile(stream);
+
+    auto dump = Profiler::read_binary(stream);
+    REQUIRE(dump);
+    CHECK(dump->node_names.size() == region_b.node_count());
+    CHECK(dump->events.size() == 3u * region_b.node_count());
+}
+
+} // namespace ltb::ddf
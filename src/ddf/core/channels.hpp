@@ -0,0 +1,157 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf.hpp"
+#include "spsc_ring_buffer.hpp"
+#include "triple_buffer.hpp"
+
+// standard
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief The consumer side of an event channel between two graphs
+template <typename T>
+struct EventChannel {
+    OutputPort<EventBuffer<T>>         received; ///< Every event that arrived since the consumer's last tick
+    std::shared_ptr<SpscRingBuffer<T>> queue; ///< Exposed so the queue depth and drop count can be monitored
+};
+
+namespace detail {
+
+/// \brief Samples the depth of a channel queue into the consumer's profiler
+struct ProfiledEdge {
+    Profiler const* profiler = nullptr; ///< The profiler 'edge' was registered with
+    std::size_t     edge     = 0u;
+
+    template <typename T>
+    auto record(Profiler* current, std::string const& name, SpscRingBuffer<T> const& queue) -> void {
+        if (!current) {
+            return;
+        }
+        // A new profiler may reuse the address of a destroyed one so the edge is also validated
+        if (current != profiler || edge >= current->edges().size() || current->edges()[edge].name != name) {
+            profiler = current;
+            edge     = current->edge(name);
+        }
+        current->record_queue_depth(edge, queue.size(), queue.dropped());
+    }
+};
+
+template <typename T>
+auto add_event_channel_receiver(ddf& consumer, std::string const& name, std::shared_ptr<SpscRingBuffer<T>> queue)
+    -> EventChannel<T> {
+    auto receiver = consumer.add_node(name + " (receive)",
+                                      Inputs<>{},
+                                      Outputs<EventBuffer<T>>{},
+                                      [queue, name, reserved = false, profiled = ProfiledEdge{}](
+                                          NodeContext& ctx) mutable {
+                                          if constexpr (profiling_enabled) {
+                                              profiled.record(ctx.profiler(), name, *queue);
+                                          }
+                                          if (queue->size() == 0u) {
+                                              return;
+                                          }
+
+                                          auto& events = ctx.event_output<T>(0);
+                                          if (!reserved) {
+                                              events.reserve(queue->capacity());
+                                              reserved = true;
+                                          }
+                                          queue->consume_all([&events](T&& event) { events.fire(std::move(event)); });
+                                      });
+    return {receiver.template output<0>(), std::move(queue)};
+}
+
+} // namespace detail
+
+/**
+ * @brief Forwards a value from a graph ticked on one thread to a graph ticked on another.
+ *
+ * The producer publishes into a lock-free triple buffer and the consumer reads the most
+ * recent value each tick (intermediate values may be skipped), which matches the
+ * semantics of a state edge. The returned output belongs to 'consumer'.
+ */
+template <typename T>
+auto add_state_channel(ddf& producer, OutputPort<T> const& value, ddf& consumer, std::string const& name)
+    -> OutputPort<T> {
+    auto buffer = std::make_shared<TripleBuffer<T>>();
+
+    producer.add_sink(
+        name + " (send)", [buffer](T const& latest) { buffer->write(latest); }, value);
+
+    auto receiver = consumer.add_node(name + " (receive)", Inputs<>{}, Outputs<T>{}, [buffer](NodeContext& ctx) {
+        if (buffer->update()) {
+            ctx.set_output<T>(0, buffer->read());
+        }
+    });
+    return receiver.template output<0>();
+}
+
+/**
+ * @brief Queues the value produced by 'value' every tick as an event for a graph ticked on another thread.
+ *
+ * The values travel through a bounded lock-free SPSC queue so neither side locks and
+ * nothing is allocated per value. Values are dropped (and counted) if the consumer falls
+ * more than 'capacity' values behind. The consumer receives them as one batch per tick.
+ */
+template <typename T>
+auto add_event_channel(ddf&                 producer,
+                       OutputPort<T> const& value,
+                       ddf&                 consumer,
+                       std::string const&   name,
+                       std::size_t          capacity = 1024u) -> EventChannel<T> {
+    auto queue = std::make_shared<SpscRingBuffer<T>>(capacity);
+
+    producer.add_sink(
+        name + " (send)", [queue](T const& event) { queue->try_push(event); }, value);
+
+    return detail::add_event_channel_receiver(consumer, name, std::move(queue));
+}
+
+/// \brief Same as above but forwards every event fired on an event port
+template <typename T>
+auto add_event_channel(ddf&                              producer,
+                       OutputPort<EventBuffer<T>> const& events,
+                       ddf&                              consumer,
+                       std::string const&                name,
+                       std::size_t                       capacity = 1024u) -> EventChannel<T> {
+    auto queue = std::make_shared<SpscRingBuffer<T>>(capacity);
+
+    producer.add_event_sink(
+        name + " (send)",
+        [queue](Span<T const> batch) {
+            for (auto const& event : batch) {
+                queue->try_push(event);
+            }
+        },
+        events);
+
+    return detail::add_event_channel_receiver(consumer, name, std::move(queue));
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,243 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "chrome_trace.hpp"
+
+// project
+#include "parallel_executor.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+
+namespace ltb::ddf {
+namespace {
+
+auto write_escaped(std::ostream& out, std::string const& str) -> void {
+    out << '"';
+    for (auto c : str) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20u) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+                        << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+/// \brief Trace timestamps are microseconds
+auto write_timestamp(std::ostream& out, std::uint64_t ns) -> void {
+    out << ns / 1000u << '.' << std::setw(3) << std::setfill('0') << ns % 1000u << std::setfill(' ');
+}
+
+} // namespace
+
+auto write_chrome_trace(std::ostream& out, std::vector<TraceRegion> const& regions) -> void {
+    ChromeTraceStream stream(out);
+
+    for (auto const& region : regions) {
+        stream.add_region(region);
+    }
+    stream.flush();
+    stream.close();
+}
+
+ChromeTraceStream::ChromeTraceStream(std::ostream& out)
+    : out_(&out), origin_ns_(std::numeric_limits<std::uint64_t>::max()) {
+    *out_ << "[";
+}
+
+ChromeTraceStream::~ChromeTraceStream() {
+    close();
+}
+
+auto ChromeTraceStream::add_region(TraceRegion region) -> void {
+    auto const pid = regions_.size() + 1u;
+
+    *out_ << (first_ ? "\n" : ",\n") << R"({"ph":"M","name":"process_name","pid":)" << pid << R"(,"args":{"name":)";
+    write_escaped(*out_, region.name);
+    *out_ << "}}";
+    first_ = false;
+
+    regions_.push_back({std::move(region), 0u, {}});
+}
+
+auto ChromeTraceStream::flush() -> void {
+    if (closed_) {
+        return;
+    }
+
+    for (auto r = 0u; r < regions_.size(); ++r) {
+        auto& streamed = regions_[r];
+        auto* profiler = streamed.region.graph->profiler();
+
+        if (!profiler) {
+            continue;
+        }
+
+        auto events = profiler->trace();
+        events.erase(std::remove_if(events.begin(),
+                                    events.end(),
+                                    [&](auto const& event) { return event.begin_ns <= streamed.last_begin_ns; }),
+                     events.end());
+
+        if (events.empty()) {
+            continue;
+        }
+
+        // The first events written define time zero for the whole trace
+        if (origin_ns_ == std::numeric_limits<std::uint64_t>::max()) {
+            origin_ns_ = events.front().begin_ns;
+            for (auto const& other : regions_) {
+                if (auto* other_profiler = other.region.graph->profiler()) {
+                    for (auto const& event : other_profiler->trace()) {
+                        origin_ns_ = std::min(origin_ns_, event.begin_ns);
+                    }
+                }
+            }
+        }
+
+        auto const pid = r + 1u;
+
+        for (auto const& event : events) {
+            auto const tid = event.worker + 1u;
+
+            if (std::find(streamed.workers.begin(), streamed.workers.end(), event.worker) == streamed.workers.end()) {
+                streamed.workers.emplace_back(event.worker);
+
+                *out_ << R"(,
+{"ph":"M","name":"thread_name","pid":)"
+                      << pid << R"(,"tid":)" << tid << R"(,"args":{"name":"worker )" << event.worker << "\"}}";
+            }
+
+            auto const& name = streamed.region.graph->node_name(event.node);
+
+            *out_ << ",\n{\"ph\":\"B\",\"name\":";
+            write_escaped(*out_, name);
+            *out_ << R"(,"cat":"node","pid":)" << pid << R"(,"tid":)" << tid << R"(,"ts":)";
+            write_timestamp(*out_, event.begin_ns - std::min(event.begin_ns, origin_ns_));
+            *out_ << "},\n{\"ph\":\"E\",\"name\":";
+            write_escaped(*out_, name);
+            *out_ << R"(,"cat":"node","pid":)" << pid << R"(,"tid":)" << tid << R"(,"ts":)";
+            write_timestamp(*out_, event.end_ns - std::min(event.end_ns, origin_ns_));
+            *out_ << "}";
+        }
+
+        streamed.last_begin_ns = events.back().begin_ns;
+    }
+    out_->flush();
+}
+
+auto ChromeTraceStream::close() -> void {
+    if (closed_) {
+        return;
+    }
+    flush();
+    *out_ << "\n]\n";
+    out_->flush();
+    closed_ = true;
+}
+
+TEST_CASE("[ltb][ddf] chrome trace export") {
+    ddf graph;
+
+    auto source = graph.add_source("source", [] { return 1; });
+    graph.add_sink("quoted \"sink\"", [](int) {}, source);
+    graph.enable_profiling(64u);
+    REQUIRE(graph.compile());
+
+    graph.tick();
+
+    std::stringstream full;
+    write_chrome_trace(full, {{"region", &graph}});
+
+    auto const json = full.str();
+    CHECK(json.front() == '[');
+    CHECK(json.find(R"({"ph":"M","name":"process_name","pid":1,"args":{"name":"region"}})") != std::string::npos);
+    CHECK(json.find("\n]\n") != std::string::npos);
+
+    if (!profiling_enabled) {
+        CHECK(json.find(R"("ph":"B")") == std::string::npos);
+        return;
+    }
+
+    CHECK(json.find(R"({"ph":"B","name":"source","cat":"node","pid":1,"tid":1,"ts":0.000})") != std::string::npos);
+    CHECK(json.find(R"("name":"quoted \"sink\"")") != std::string::npos);
+    CHECK(json.find(R"("name":"thread_name")") != std::string::npos);
+
+    SUBCASE("streaming only writes new events") {
+        std::stringstream streamed;
+        {
+            ChromeTraceStream stream(streamed);
+            stream.add_region({"region", &graph});
+
+            stream.flush();
+            graph.tick();
+            stream.flush();
+            stream.flush();
+        }
+
+        auto const text  = streamed.str();
+        auto       count = 0u;
+        for (auto pos = text.find(R"("ph":"B")"); pos != std::string::npos; pos = text.find(R"("ph":"B")", pos + 1u)) {
+            ++count;
+        }
+        CHECK(count == 4u); // Two nodes over two ticks
+        CHECK(text.find("\n]\n") != std::string::npos);
+    }
+
+    SUBCASE("parallel ticks are split across worker threads") {
+        ParallelExecutor executor(2u);
+        for (auto i = 0; i < 4; ++i) {
+            graph.tick(executor);
+        }
+
+        std::stringstream parallel;
+        write_chrome_trace(parallel, {{"region", &graph}});
+        CHECK(parallel.str().find(R"("ph":"E")") != std::string::npos);
+    }
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,95 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf.hpp"
+
+// standard
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief A profiled graph to include in a trace. Each region becomes a process in the trace viewer.
+struct TraceRegion {
+    std::string name;
+    ddf const*  graph;
+};
+
+/**
+ * @brief Writes the trace events recorded by each region's profiler in the Chrome Trace Event
+ *        JSON format, which can be loaded into chrome://tracing or Perfetto.
+ *
+ * Every node execution becomes a begin/end pair on the thread of the worker that ran it,
+ * so overlapping regions, stalls and the critical path through a tick are visible side by
+ * side. Regions must have profiling enabled with a non-zero trace capacity.
+ */
+auto write_chrome_trace(std::ostream& out, std::vector<TraceRegion> const& regions) -> void;
+
+/**
+ * @brief Streams trace events to 'out' as regions tick.
+ *
+ * Call 'flush' regularly (at least once per trace capacity worth of node executions) to
+ * append every event recorded since the previous flush. The closing bracket is written by
+ * 'close' or the destructor, but the JSON array format is also valid without it so a
+ * trace cut short by a crash still loads.
+ *
+ * Like the rest of the profiling API, 'flush' must not run while a region is ticking.
+ */
+class ChromeTraceStream {
+public:
+    explicit ChromeTraceStream(std::ostream& out);
+    ~ChromeTraceStream();
+
+    ChromeTraceStream(ChromeTraceStream const&) = delete;
+    ChromeTraceStream(ChromeTraceStream&&)      = delete;
+    auto operator=(ChromeTraceStream const&) -> ChromeTraceStream& = delete;
+    auto operator=(ChromeTraceStream&&) -> ChromeTraceStream& = delete;
+
+    /// \brief Starts streaming the events of 'region'. The graph must outlive the stream.
+    auto add_region(TraceRegion region) -> void;
+
+    /// \brief Appends every event recorded since the last flush
+    auto flush() -> void;
+
+    /// \brief Finishes the JSON array. Nothing can be written afterwards.
+    auto close() -> void;
+
+private:
+    struct StreamedRegion {
+        TraceRegion                region;
+        std::uint64_t              last_begin_ns = 0u; ///< The newest event already written
+        std::vector<std::uint32_t> workers; ///< Workers whose thread names have been written
+    };
+
+    std::ostream*               out_;
+    std::uint64_t               origin_ns_; ///< Timestamps are written relative to this
+    std::vector<StreamedRegion> regions_;
+    bool                        first_ = true;
+    bool                        closed_ = false;
+};
+
+} // namespace ltb::ddf
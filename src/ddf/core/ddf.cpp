@@ -22,4 +22,741 @@
 // ///////////////////////////////////////////////////////////////////////////////////////
 #include "ddf.hpp"
 
-namespace ltb::ddf {} // namespace ltb::ddf
+// project
+#include "parallel_executor.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace ltb::ddf {
+
+/// \brief A replacement graph being built and compiled on a background thread
+struct StagedGraph {
+    std::promise<util::Result<void>>       promise;
+    std::shared_future<util::Result<void>> result = promise.get_future().share();
+    std::unique_ptr<ddf>                   graph; ///< Set by the worker before 'ready' if the build succeeded
+    std::atomic_bool                       ready{false};
+    std::thread                            worker;
+
+    ~StagedGraph() {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+};
+
+/// \brief Everything a swapped out graph owns. Destroyed once no reader has its plan pinned.
+struct RetiredGraph {
+    std::unique_ptr<Arena>         node_arena;
+    std::vector<NodeSpec>          nodes;
+    std::unique_ptr<ExecutionPlan> plan;
+};
+
+struct ddf::HotSwap {
+    EpochReclaimer                    reclaimer;
+    std::atomic<ExecutionPlan const*> published{nullptr}; ///< The plan handed to 'pin'
+    std::mutex                        staged_mutex; ///< 'stage' may be called while another thread ticks
+    std::unique_ptr<StagedGraph>      staged;
+    std::atomic<std::uint64_t>        swap_count{0u};
+};
+
+// Created up front so 'stage' never races a ticking thread to create it.
+ddf::ddf() : hot_swap_(std::make_unique<HotSwap>()) {}
+ddf::~ddf() = default;
+
+ddf::ddf(ddf&&) noexcept = default;
+
+auto ddf::operator=(ddf&& other) noexcept -> ddf& {
+    if (this != &other) {
+        // Wait for any background compile, then destroy the bodies before the arena they live in.
+        hot_swap_.reset();
+        plan_.reset();
+        nodes_.clear();
+
+        node_arena_  = std::move(other.node_arena_);
+        nodes_       = std::move(other.nodes_);
+        plan_        = std::move(other.plan_);
+        mode_        = other.mode_;
+        fuse_chains_ = other.fuse_chains_;
+        profiler_    = std::move(other.profiler_);
+        hot_swap_    = std::move(other.hot_swap_);
+    }
+    return *this;
+}
+
+template <typename Run>
+auto ddf::profiled_tick(Run&& run) -> void {
+    if constexpr (profiling_enabled) {
+        if (profiler_) {
+            auto const begin = profiler_->now();
+            run();
+            profiler_->record_tick(begin, profiler_->now());
+            return;
+        }
+    }
+    run();
+}
+
+auto ddf::connect(PortRef const& from, PortRef const& to) -> util::Result<void> {
+    if (from.node >= nodes_.size() || from.index >= nodes_[from.node].output_types.size()) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Invalid output port"));
+    }
+    if (to.node >= nodes_.size() || to.index >= nodes_[to.node].input_types.size()) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Invalid input port"));
+    }
+
+    auto const& output_type = *nodes_[from.node].output_types[from.index];
+    auto const& input_type  = *nodes_[to.node].input_types[to.index];
+
+    if (!same_type(output_type, input_type)) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Cannot connect output of type '" + output_type.type_name()
+                                                  + "' to input of type '" + input_type.type_name() + "'"));
+    }
+
+    auto& source = nodes_[to.node].input_sources[to.index];
+
+    if (source.node != invalid_node) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Input " + std::to_string(to.index) + " of node '"
+                                                  + nodes_[to.node].name + "' is already connected"));
+    }
+
+    source = from;
+    replace_plan(nullptr);
+    return util::success();
+}
+
+auto ddf::compile() -> util::Result<void> {
+    auto arena = std::make_unique<Arena>();
+    auto plan  = ExecutionPlan::compile(nodes_, *arena, fuse_chains_);
+
+    if (!plan) {
+        return tl::make_unexpected(plan.error());
+    }
+
+    // Every body now lives in the new arena so the old one can be released.
+    node_arena_ = std::move(arena);
+    replace_plan(std::move(plan.value()));
+    plan_->set_evaluation_mode(mode_);
+    plan_->set_profiler(profiler_.get());
+    return util::success();
+}
+
+auto ddf::is_compiled() const -> bool {
+    return plan_ != nullptr;
+}
+
+auto ddf::set_evaluation_mode(EvaluationMode mode) -> ddf& {
+    mode_ = mode;
+    if (plan_) {
+        plan_->set_evaluation_mode(mode_);
+    }
+    return *this;
+}
+
+auto ddf::evaluation_mode() const -> EvaluationMode {
+    return mode_;
+}
+
+auto ddf::set_node_fusion(bool enabled) -> ddf& {
+    fuse_chains_ = enabled;
+    return *this;
+}
+
+auto ddf::node_fusion() const -> bool {
+    return fuse_chains_;
+}
+
+auto ddf::write_fusion_report(std::ostream& out) const -> void {
+    for (auto const& chain : compiled_plan().fused_chains()) {
+        for (auto i = 0u; i < chain.size(); ++i) {
+            out << (i == 0u ? "" : " -> ") << nodes_[chain[i]].name;
+        }
+        out << '\n';
+    }
+}
+
+auto ddf::enable_profiling(std::size_t trace_capacity) -> ddf& {
+    if constexpr (profiling_enabled) {
+        if (!profiler_) {
+            profiler_ = std::make_unique<Profiler>();
+        }
+        profiler_->set_trace_capacity(trace_capacity);
+
+        if (plan_) {
+            plan_->set_profiler(profiler_.get());
+        }
+    }
+    return *this;
+}
+
+auto ddf::disable_profiling() -> ddf& {
+    if (plan_) {
+        plan_->set_profiler(nullptr);
+    }
+    profiler_.reset();
+    return *this;
+}
+
+auto ddf::profiler() const -> Profiler const* {
+    return profiler_.get();
+}
+
+auto ddf::write_profile(std::ostream& out) const -> void {
+    std::vector<std::string> names;
+    names.reserve(nodes_.size());
+
+    for (auto const& node : nodes_) {
+        names.emplace_back(node.name);
+    }
+
+    (profiler_ ? *profiler_ : Profiler{}).write_binary(out, names);
+}
+
+auto ddf::tick() -> void {
+    apply_staged();
+    profiled_tick([this] { compiled_plan().run(); });
+}
+
+auto ddf::tick(ParallelExecutor& executor) -> void {
+    apply_staged();
+    profiled_tick([this, &executor] { executor.run(compiled_plan()); });
+}
+
+auto ddf::stage(std::function<util::Result<ddf>()> build) -> std::shared_future<util::Result<void>> {
+    auto& swap   = hot_swap();
+    auto  staged = std::make_unique<StagedGraph>();
+    auto* state  = staged.get();
+
+    state->worker = std::thread([state, build = std::move(build)] {
+        auto status = util::Result<void>(util::success());
+
+        try {
+            auto built = build();
+
+            if (built && !built->is_compiled()) {
+                if (auto compiled = built->compile(); !compiled) {
+                    built = tl::make_unexpected(compiled.error());
+                }
+            }
+
+            if (built) {
+                state->graph = std::make_unique<ddf>(std::move(*built));
+            } else {
+                status = tl::make_unexpected(built.error());
+            }
+        } catch (std::exception const& e) {
+            status = tl::make_unexpected(LTB_MAKE_ERROR(std::string("Staged graph build threw: ") + e.what()));
+        }
+
+        state->ready.store(true, std::memory_order_release);
+        state->promise.set_value(std::move(status));
+    });
+
+    auto result = staged->result;
+    {
+        auto lock = std::lock_guard<std::mutex>(swap.staged_mutex);
+        std::swap(swap.staged, staged);
+    }
+    // 'staged' now holds any previously staged graph, which is discarded after its worker finishes
+    return result;
+}
+
+auto ddf::stage(ddf replacement) -> std::shared_future<util::Result<void>> {
+    auto shared = std::make_shared<ddf>(std::move(replacement));
+    return stage([shared]() -> util::Result<ddf> { return std::move(*shared); });
+}
+
+auto ddf::apply_staged() -> bool {
+    if (!hot_swap_) {
+        return false;
+    }
+
+    auto& swap   = *hot_swap_;
+    auto  staged = std::unique_ptr<StagedGraph>();
+    {
+        auto lock = std::lock_guard<std::mutex>(swap.staged_mutex);
+        if (!swap.staged || !swap.staged->ready.load(std::memory_order_acquire)) {
+            return false;
+        }
+        staged = std::move(swap.staged);
+    }
+    staged->worker.join();
+
+    if (!staged->graph) {
+        return false;
+    }
+
+    auto& next = *staged->graph;
+
+    // Publish the new plan before retiring the old graph so new readers never see the old one
+    swap.published.store(next.plan_.get(), std::memory_order_seq_cst);
+
+    auto retired        = std::make_shared<RetiredGraph>();
+    retired->node_arena = std::move(node_arena_);
+    retired->nodes      = std::move(nodes_);
+    retired->plan       = std::move(plan_);
+    swap.reclaimer.retire(std::move(retired));
+
+    node_arena_ = std::move(next.node_arena_);
+    nodes_      = std::move(next.nodes_);
+    plan_       = std::move(next.plan_);
+
+    plan_->set_evaluation_mode(mode_);
+    if (profiler_) {
+        profiler_->reset();
+    }
+    plan_->set_profiler(profiler_.get());
+
+    ++swap.swap_count;
+    swap.reclaimer.collect();
+    return true;
+}
+
+auto ddf::swap_count() const -> std::uint64_t {
+    return hot_swap_ ? hot_swap_->swap_count.load() : 0u;
+}
+
+auto ddf::pin() const -> PinnedPlan {
+    if (!hot_swap_) {
+        return {EpochReclaimer::Guard{}, nullptr};
+    }
+
+    auto guard = hot_swap_->reclaimer.enter();
+    return {std::move(guard), hot_swap_->published.load(std::memory_order_seq_cst)};
+}
+
+auto ddf::pending_reclamation() const -> std::size_t {
+    return hot_swap_ ? hot_swap_->reclaimer.pending() : 0u;
+}
+
+auto ddf::reserve(std::size_t node_count) -> void {
+    nodes_.reserve(node_count);
+}
+
+auto ddf::node_count() const -> std::size_t {
+    return nodes_.size();
+}
+
+auto ddf::node_name(NodeId node) const -> std::string const& {
+    return nodes_.at(node).name;
+}
+
+auto ddf::nodes() const -> std::vector<NodeSpec> const& {
+    return nodes_;
+}
+
+auto ddf::plan() const -> ExecutionPlan const& {
+    return compiled_plan();
+}
+
+auto ddf::add_node_spec(NodeSpec spec) -> NodeId {
+    nodes_.emplace_back(std::move(spec));
+    replace_plan(nullptr);
+    return static_cast<NodeId>(nodes_.size() - 1u);
+}
+
+auto ddf::node_arena() -> Arena& {
+    if (!node_arena_) {
+        node_arena_ = std::make_unique<Arena>();
+    }
+    return *node_arena_;
+}
+
+auto ddf::hot_swap() -> HotSwap& {
+    if (!hot_swap_) {
+        hot_swap_ = std::make_unique<HotSwap>();
+    }
+    return *hot_swap_;
+}
+
+auto ddf::replace_plan(std::unique_ptr<ExecutionPlan> plan) -> void {
+    if (!plan_ && !plan) {
+        return;
+    }
+
+    auto& swap = hot_swap();
+    swap.published.store(plan.get(), std::memory_order_seq_cst);
+
+    if (plan_) {
+        swap.reclaimer.retire(std::shared_ptr<ExecutionPlan>(std::move(plan_)));
+    }
+    plan_ = std::move(plan);
+    swap.reclaimer.collect();
+}
+
+auto ddf::compiled_plan() const -> ExecutionPlan& {
+    if (!plan_) {
+        throw std::runtime_error("The ddf graph has not been compiled");
+    }
+    return *plan_;
+}
+
+TEST_CASE("[ltb][ddf] chain of nodes runs in topological order") {
+    ddf graph;
+
+    auto counter = 0;
+
+    auto sink    = graph.add_node("sink", Inputs<int>{}, Outputs<>{}, [](NodeContext&) {});
+    auto source  = graph.add_source("source", [&counter] { return ++counter; });
+    auto doubled = graph.add_transform("double", [](int x) { return x * 2; }, source);
+    auto sum     = graph.add_transform("sum", [](int x, int y) { return x + y; }, doubled, doubled);
+
+    // The sink was added first so the sort has to move it to the end
+    REQUIRE(graph.connect(sum, sink.input<0>()));
+
+    REQUIRE(graph.compile());
+    CHECK(graph.plan().execution_order() == std::vector<NodeId>{1u, 2u, 3u, 0u});
+
+    graph.tick();
+    CHECK(graph.value(doubled) == 2);
+    CHECK(graph.value(sum) == 4);
+
+    graph.tick();
+    CHECK(graph.value(doubled) == 4);
+    CHECK(graph.value(sum) == 8);
+}
+
+TEST_CASE("[ltb][ddf] compile errors") {
+    ddf graph;
+
+    auto a = graph.add_node("a", Inputs<int>{}, Outputs<int>{}, [](NodeContext&) {});
+    auto b = graph.add_node("b", Inputs<int>{}, Outputs<int>{}, [](NodeContext&) {});
+
+    SUBCASE("unconnected input") {
+        REQUIRE(graph.connect(a.output<0>(), b.input<0>()));
+        CHECK_FALSE(graph.compile());
+        CHECK_FALSE(graph.is_compiled());
+        CHECK_THROWS(graph.tick());
+    }
+
+    SUBCASE("cycle") {
+        REQUIRE(graph.connect(a.output<0>(), b.input<0>()));
+        REQUIRE(graph.connect(b.output<0>(), a.input<0>()));
+        CHECK_FALSE(graph.compile());
+    }
+
+    SUBCASE("invalid connections") {
+        auto text = graph.add_source("text", [] { return std::string("blarg"); });
+
+        CHECK_FALSE(graph.connect(PortRef(text), PortRef(a.input<0>())));
+        CHECK_FALSE(graph.connect(PortRef{42u, 0u}, PortRef(a.input<0>())));
+        CHECK_FALSE(graph.connect(PortRef(a.output<0>()), PortRef{b.id(), 3u}));
+
+        REQUIRE(graph.connect(a.output<0>(), b.input<0>()));
+        CHECK_FALSE(graph.connect(b.output<0>(), b.input<0>()));
+    }
+}
+
+TEST_CASE("[ltb][ddf] incremental evaluation only runs nodes with changed inputs") {
+    ddf graph;
+    graph.set_evaluation_mode(EvaluationMode::Incremental);
+
+    auto fast_input = 0;
+    auto slow_input = 0;
+    auto fast_runs  = 0;
+    auto slow_runs  = 0;
+    auto sum_runs   = 0;
+
+    auto fast = graph.add_source("fast", [&] { return fast_input; });
+    auto slow = graph.add_source("slow", [&] { return slow_input; });
+
+    auto fast_double = graph.add_transform("fast double", [&](int x) { return ++fast_runs, x * 2; }, fast);
+    auto slow_double = graph.add_transform("slow double", [&](int x) { return ++slow_runs, x * 2; }, slow);
+    auto parity      = graph.add_transform("parity", [](int x) { return x % 4; }, slow_double);
+    auto sum = graph.add_transform("sum", [&](int x, int y) { return ++sum_runs, x + y; }, fast_double, parity);
+
+    REQUIRE(graph.compile());
+
+    // Everything runs on the first tick
+    graph.tick();
+    CHECK(graph.plan().executed_count() == 6u);
+    CHECK(graph.value(sum) == 0);
+
+    // Nothing changed so only the sources run
+    graph.tick();
+    CHECK(graph.plan().executed_count() == 2u);
+    CHECK(graph.value(sum) == 0);
+
+    fast_input = 3;
+    graph.tick();
+    CHECK(fast_runs == 2);
+    CHECK(slow_runs == 1);
+    CHECK(sum_runs == 2);
+    CHECK(graph.value(sum) == 6);
+
+    // 'parity' produces the same value (4 % 4 == 0) so 'sum' is cut off
+    slow_input = 2;
+    graph.tick();
+    CHECK(slow_runs == 2);
+    CHECK(sum_runs == 2);
+    CHECK(graph.value(sum) == 6);
+
+    slow_input = 3;
+    graph.tick();
+    CHECK(sum_runs == 3);
+    CHECK(graph.value(sum) == 8);
+
+    // Full evaluation runs everything again
+    graph.set_evaluation_mode(EvaluationMode::Full);
+    graph.tick();
+    CHECK(graph.plan().executed_count() == 6u);
+}
+
+TEST_CASE("[ltb][ddf] node bodies are stored in execution order and can use scratch memory") {
+    ddf graph;
+
+    auto sink = graph.add_node("sink", Inputs<int>{}, Outputs<>{}, [](NodeContext&) {});
+
+    auto source = graph.add_source("source", [] { return 3; });
+    auto range  = graph.add_node("range", Inputs<int>{}, Outputs<int>{}, [](NodeContext& ctx) {
+        std::vector<int, ArenaAllocator<int>> values(ctx.scratch());
+        for (auto i = 0; i < ctx.input<int>(0); ++i) {
+            values.push_back(i + 1);
+        }
+        ctx.output<int>(0) = std::accumulate(values.begin(), values.end(), 0);
+    });
+
+    REQUIRE(graph.connect(source, range.input<0>()));
+    REQUIRE(graph.connect(range.output<0>(), sink.input<0>()));
+    REQUIRE(graph.compile());
+
+    auto const& order = graph.plan().execution_order();
+    REQUIRE(order == std::vector<NodeId>{1u, 2u, 0u});
+
+    // The sink was added first but its body is relocated behind the nodes it depends on
+    for (auto i = 1u; i < order.size(); ++i) {
+        auto const* previous = graph.nodes()[order[i - 1u]].body.state();
+        CHECK(std::less<void const*>{}(previous, graph.nodes()[order[i]].body.state()));
+    }
+
+    graph.tick();
+    CHECK(graph.value(range.output<0>()) == 6);
+
+    auto const reserved = graph.plan().scratch().bytes_reserved();
+    CHECK(reserved > 0u);
+
+    // Scratch memory is reused each tick instead of growing
+    for (auto i = 0; i < 10; ++i) {
+        graph.tick();
+    }
+    CHECK(graph.value(range.output<0>()) == 6);
+    CHECK(graph.plan().scratch().bytes_reserved() == reserved);
+}
+
+TEST_CASE("[ltb][ddf] staged graphs are swapped in between ticks") {
+    ddf graph;
+
+    auto source = graph.add_source("source", [] { return 1; });
+    auto scaled = graph.add_transform("scaled", [](int x) { return x * 2; }, source);
+    REQUIRE(graph.compile());
+
+    graph.tick();
+    CHECK(graph.value(scaled) == 2);
+    CHECK(graph.swap_count() == 0u);
+
+    SUBCASE("successful swap") {
+        auto const pinned = graph.pin();
+        REQUIRE(pinned);
+        CHECK(pinned.get() == &graph.plan());
+
+        auto result = graph.stage([]() -> util::Result<ddf> {
+            ddf  replacement;
+            auto next_source = replacement.add_source("source", [] { return 10; });
+            replacement.add_transform("scaled", [](int x) { return x * 3; }, next_source);
+            return replacement;
+        });
+        REQUIRE(result.get());
+
+        graph.tick();
+        CHECK(graph.swap_count() == 1u);
+        CHECK(graph.value(scaled) == 30);
+
+        // The old plan is still pinned so it can't be destroyed yet
+        CHECK(pinned.get() != &graph.plan());
+        CHECK(pinned->execution_order().size() == 2u);
+        CHECK(graph.pending_reclamation() > 0u);
+    }
+
+    SUBCASE("ports from the old graph are checked") {
+        auto result = graph.stage([]() -> util::Result<ddf> {
+            ddf replacement;
+            replacement.add_source("source", [] { return 0.5; });
+            return replacement;
+        });
+        REQUIRE(result.get());
+
+        graph.tick();
+        CHECK(graph.swap_count() == 1u);
+
+        // 'scaled' no longer exists and 'source' now holds a different type
+        CHECK_THROWS_AS(graph.value(scaled), std::out_of_range);
+        CHECK_THROWS_AS(graph.value(source), std::invalid_argument);
+        CHECK(graph.value(OutputPort<double>{source.node, 0u}) == 0.5);
+    }
+
+    SUBCASE("failed swap") {
+        auto result = graph.stage([]() -> util::Result<ddf> {
+            ddf  replacement;
+            auto a = replacement.add_node("a", Inputs<int>{}, Outputs<int>{}, [](NodeContext&) {});
+            auto b = replacement.add_node("b", Inputs<int>{}, Outputs<int>{}, [](NodeContext&) {});
+            // 'a' is never given an input
+            if (auto connected = replacement.connect(a.output<0>(), b.input<0>()); !connected) {
+                return tl::make_unexpected(connected.error());
+            }
+            return replacement;
+        });
+        CHECK_FALSE(result.get());
+
+        // The original graph keeps running
+        graph.tick();
+        CHECK(graph.swap_count() == 0u);
+        CHECK(graph.value(scaled) == 2);
+    }
+
+    // Once nothing is pinned the retired plans can be released
+    graph.stage(ddf{}).wait();
+    graph.tick();
+    CHECK(graph.pending_reclamation() == 0u);
+}
+
+TEST_CASE("[ltb][ddf] async transforms are polled without blocking the tick") {
+    ddf graph;
+    graph.set_evaluation_mode(EvaluationMode::Incremental);
+
+    auto input    = 1;
+    auto promises = std::vector<std::promise<int>>();
+    promises.reserve(2u);
+
+    auto source = graph.add_source("source", [&input] { return input; });
+    auto remote = graph.add_async_transform(
+        "remote",
+        [&promises](int x) {
+            promises.emplace_back();
+            return Async<int>::from_future(promises.back().get_future()).then([x](int y) { return x * y; });
+        },
+        source);
+    auto plus_one = graph.add_transform("plus one", [](int x) { return x + 1; }, remote);
+    REQUIRE(graph.compile());
+
+    graph.tick();
+    REQUIRE(promises.size() == 1u);
+    CHECK(graph.value(remote) == 0);
+    CHECK(graph.value(plus_one) == 1);
+
+    // Still waiting: the async node is polled but nothing downstream runs
+    graph.tick();
+    CHECK(graph.plan().executed_count() == 2u);
+
+    // A new input while the first call is in flight is picked up once it finishes
+    input = 2;
+    promises[0].set_value(10);
+    graph.tick();
+    CHECK(graph.value(remote) == 10);
+    CHECK(graph.value(plus_one) == 11);
+    REQUIRE(promises.size() == 2u);
+
+    promises[1].set_value(10);
+    graph.tick();
+    CHECK(graph.value(remote) == 20);
+    CHECK(graph.value(plus_one) == 21);
+
+    // Nothing is pending or changed so only the source runs
+    graph.tick();
+    CHECK(graph.plan().executed_count() == 1u);
+    CHECK(promises.size() == 2u);
+}
+
+TEST_CASE("[ltb][ddf] one thread interleaves many waiting async nodes") {
+    ddf graph;
+
+    constexpr auto node_count = 1000;
+    constexpr auto delay      = std::chrono::milliseconds(20);
+
+    auto source = graph.add_source("source", [] { return 1; });
+    auto total  = std::vector<OutputPort<int>>();
+
+    for (auto i = 0; i < node_count; ++i) {
+        total.emplace_back(graph.add_async_transform(
+            "wait " + std::to_string(i), [delay](int x) { return Async<int>::after(delay, x); }, source));
+    }
+    REQUIRE(graph.compile());
+
+    auto const begin = std::chrono::steady_clock::now();
+    auto       done  = 0;
+
+    while (done < node_count) {
+        graph.tick();
+        done = static_cast<int>(
+            std::count_if(total.begin(), total.end(), [&graph](auto const& port) { return graph.value(port) == 1; }));
+    }
+
+    // Blocking on each delay in turn would take node_count * delay
+    CHECK(std::chrono::steady_clock::now() - begin < delay * (node_count / 10));
+}
+
+TEST_CASE("[ltb][ddf] linear chains are fused into single units") {
+    ddf graph;
+
+    auto source = graph.add_source("source", [i = 0]() mutable { return ++i; });
+    auto left   = graph.add_transform("left", [](int x) { return x + 1; }, source);
+    auto right  = graph.add_transform("right", [](int x) { return x * 2; }, source);
+
+    // A chain of maps, then a filter that holds on to the last multiple of three
+    auto chain = graph.add_transform("scale", [](int x) { return x * 10; }, right);
+    chain      = graph.add_transform("offset", [](int x) { return x + 2; }, chain);
+    chain      = graph.add_transform(
+        "filter", [last = 0](int x) mutable { return last = (x % 3 == 0 ? x : last); }, chain);
+
+    auto joined = graph.add_transform("join", [](int x, int y) { return x + y; }, left, chain);
+
+    REQUIRE(graph.compile());
+
+    auto report = std::ostringstream();
+    graph.write_fusion_report(report);
+    CHECK(report.str() == "right -> scale -> offset -> filter\n");
+
+    auto const& plan = graph.plan();
+    CHECK(plan.units().size() == 4u);
+    CHECK(plan.fused_chains() == std::vector<std::vector<NodeId>>{{2u, 3u, 4u, 5u}});
+
+    auto results = std::vector<int>();
+    for (auto i = 0; i < 5; ++i) {
+        graph.tick();
+        results.emplace_back(graph.value(joined));
+    }
+    CHECK(results == std::vector<int>{2, 45, 46, 47, 108});
+
+    // Fusion only changes the schedule, not the results
+    SUBCASE("without fusion") {
+        graph.set_node_fusion(false);
+        REQUIRE(graph.compile());
+        CHECK(graph.plan().units().size() == 7u);
+        CHECK(graph.plan().fused_chains().empty());
+    }
+
+    SUBCASE("parallel") {
+        REQUIRE(graph.compile());
+    }
+
+    // The node state carries on from the serial ticks
+    ParallelExecutor executor(2u);
+    results.clear();
+    for (auto i = 0; i < 5; ++i) {
+        graph.tick(executor);
+        results.emplace_back(graph.value(joined));
+    }
+    CHECK(results == std::vector<int>{109, 110, 171, 172, 173});
+}
+
+} // namespace ltb::ddf
@@ -22,8 +22,436 @@
 // ///////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+// project
+#include "async.hpp"
+#include "epoch_reclaimer.hpp"
+#include "execution_plan.hpp"
+#include "memo_cache.hpp"
+#include "node_context.hpp"
+#include "node_spec.hpp"
+#include "ports.hpp"
+#include "profiler.hpp"
+#include "type_ops.hpp"
+#include "ltb/util/result.hpp"
+
+// standard
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace ltb::ddf {
 
-class ddf {};
+class ParallelExecutor;
+
+namespace detail {
+
+template <typename... Ts, typename Func, std::size_t... Is>
+auto invoke_with_inputs(Func& func, NodeContext const& ctx, std::index_sequence<Is...>) -> decltype(auto) {
+    return func(ctx.input<Ts>(static_cast<PortIndex>(Is))...);
+}
+
+inline auto latest_input_version(NodeContext const& ctx, std::size_t input_count) -> std::uint64_t {
+    auto latest = std::uint64_t{0u};
+    for (auto i = 0u; i < input_count; ++i) {
+        latest = std::max(latest, ctx.input_version(static_cast<PortIndex>(i)));
+    }
+    return latest;
+}
+
+} // namespace detail
+
+/**
+ * @brief A compiled plan that is kept alive for as long as this object exists, even if the
+ *        graph swaps in a new plan in the meantime. Null if the graph was not compiled.
+ *
+ * Pinned plans are safe to inspect from any thread. Output values are only consistent
+ * when read between ticks.
+ */
+class PinnedPlan {
+public:
+    PinnedPlan(EpochReclaimer::Guard guard, ExecutionPlan const* plan) : guard_(std::move(guard)), plan_(plan) {}
+
+    auto get() const -> ExecutionPlan const* { return plan_; }
+    auto operator->() const -> ExecutionPlan const* { return plan_; }
+    auto operator*() const -> ExecutionPlan const& { return *plan_; }
+    explicit operator bool() const { return plan_ != nullptr; }
+
+private:
+    EpochReclaimer::Guard guard_;
+    ExecutionPlan const*  plan_;
+};
+
+/**
+ * @brief A dataflow graph that owns its nodes and typed edges.
+ *
+ * Nodes are added with their port types and a body, then connected output -> input.
+ * 'compile' turns the graph into a flat ExecutionPlan and 'tick' runs every node once in
+ * topological order:
+ *
+ *     ltb::ddf::ddf graph;
+ *
+ *     auto temperature = graph.add_source("temperature", [] { return get_temperature(); });
+ *     auto fahrenheit  = graph.add_transform("to F", [](int c) { return c * 9 / 5 + 32; }, temperature);
+ *     graph.add_sink("print", [](int f) { std::cout << f << std::endl; }, fahrenheit);
+ *
+ *     graph.compile().value_or_throw();
+ *     graph.tick();
+ *
+ * Adding nodes or connections after compiling discards the compiled plan.
+ *
+ * Node bodies are stored in an arena owned by the graph rather than individually on the
+ * heap. Each compile moves them into a fresh arena in execution order, so a tick touches
+ * node state sequentially and the steady state performs no allocations.
+ *
+ * A running graph can be replaced without stopping whatever ticks it. 'stage' builds and
+ * compiles the replacement on a background thread and the next 'tick' after it is ready
+ * swaps it in before running. The old plan is reclaimed once no thread has it pinned.
+ */
+class ddf {
+public:
+    ddf();
+    ~ddf();
+
+    ddf(ddf const&) = delete;
+    ddf(ddf&&) noexcept;
+    auto operator=(ddf const&) -> ddf& = delete;
+    auto operator=(ddf&&) noexcept -> ddf&;
+
+    /// \brief Adds a node with the given port types. 'body' is called with a NodeContext each tick.
+    template <typename... Ins, typename... Outs, typename Body>
+    auto add_node(std::string name, Inputs<Ins...>, Outputs<Outs...>, Body&& body)
+        -> Node<Inputs<Ins...>, Outputs<Outs...>>;
+
+    /// \brief Adds a node with no inputs whose single output is set to 'func()' each tick
+    template <typename Func>
+    auto add_source(std::string name, Func&& func) -> OutputPort<std::decay_t<std::invoke_result_t<Func&>>>;
+
+    /// \brief Adds a node whose single output is set to 'func(inputs...)' each tick
+    template <typename Func, typename... Ts>
+    auto add_transform(std::string name, Func&& func, OutputPort<Ts> const&... inputs)
+        -> OutputPort<std::decay_t<std::invoke_result_t<Func&, Ts const&...>>>;
+
+    /// \brief Adds a node whose output is set when the Async returned by 'func(inputs...)' completes.
+    ///        The node polls the Async once per tick instead of blocking. Once it completes, 'func'
+    ///        is called again if any input changed in the meantime. Until the first result the
+    ///        output holds a default constructed value.
+    template <typename Func, typename... Ts>
+    auto add_async_transform(std::string name, Func&& func, OutputPort<Ts> const&... inputs)
+        -> OutputPort<typename std::decay_t<std::invoke_result_t<Func&, Ts const&...>>::value_type>;
+
+    /// \brief Like 'add_transform' but looks 'func(inputs...)' up in 'cache' before calling it, so
+    ///        inputs that repeat are not recomputed. 'func' must be pure. The cache may be shared
+    ///        by nodes calling the same function, including nodes ticked in parallel.
+    template <typename Func, typename T, typename... Ts>
+    auto add_memoized_transform(std::string                          name,
+                                std::shared_ptr<MemoCache<T(Ts...)>> cache,
+                                Func&&                               func,
+                                OutputPort<Ts> const&... inputs) -> OutputPort<T>;
+
+    /// \brief Adds a node with no outputs that calls 'func(inputs...)' each tick
+    template <typename Func, typename... Ts>
+    auto add_sink(std::string name, Func&& func, OutputPort<Ts> const&... inputs) -> NodeId;
+
+    /// \brief Adds a node with no inputs that fires a batch of events each tick with 'func(EventBuffer<T>&)'
+    template <typename T, typename Func>
+    auto add_event_source(std::string name, Func&& func) -> OutputPort<EventBuffer<T>>;
+
+    /// \brief Adds a node that maps each tick's batch of input events to a batch of output events with
+    ///        'func(Span<T const>, EventBuffer<R>&)'. 'func' is only called on ticks with input events.
+    template <typename R, typename Func, typename T>
+    auto add_event_transform(std::string name, Func&& func, OutputPort<EventBuffer<T>> const& input)
+        -> OutputPort<EventBuffer<R>>;
+
+    /// \brief Adds a node that receives each tick's batch of events with 'func(Span<T const>)'.
+    ///        'func' is only called on ticks with events.
+    template <typename Func, typename T>
+    auto add_event_sink(std::string name, Func&& func, OutputPort<EventBuffer<T>> const& input) -> NodeId;
+
+    /// \brief Connects an output to an input of the same type. Each input can only be connected once.
+    template <typename T>
+    auto connect(OutputPort<T> const& from, InputPort<T> const& to) -> util::Result<void>;
+
+    /// \brief Connects untyped ports. Types are checked at runtime.
+    auto connect(PortRef const& from, PortRef const& to) -> util::Result<void>;
+
+    /// \brief Builds the execution plan. Fails if the graph has cycles or unconnected inputs.
+    auto compile() -> util::Result<void>;
+
+    /// \brief True if the graph has been compiled and not modified since
+    auto is_compiled() const -> bool;
+
+    /// \brief Switches between running every node each tick and only re-running nodes whose inputs
+    ///        changed. In incremental mode nodes with inputs should be pure functions of those inputs.
+    auto set_evaluation_mode(EvaluationMode mode) -> ddf&;
+    auto evaluation_mode() const -> EvaluationMode;
+
+    /// \brief Whether 'compile' fuses linear chains of nodes into single scheduling units (the
+    ///        default). Takes effect the next time the graph is compiled.
+    auto set_node_fusion(bool enabled) -> ddf&;
+    auto node_fusion() const -> bool;
+
+    /// \brief Writes one line per fused chain listing the names of its nodes in execution order.
+    ///        The graph must be compiled.
+    auto write_fusion_report(std::ostream& out) const -> void;
+
+    /// \brief Builds a replacement graph with 'build' and compiles it on a background thread.
+    ///        The first tick after it compiles swaps it in. A previously staged graph that has
+    ///        not been swapped in yet is discarded. The returned future reports build errors.
+    auto stage(std::function<util::Result<ddf>()> build) -> std::shared_future<util::Result<void>>;
+
+    /// \brief Compiles 'replacement' on a background thread and swaps it in at the next tick
+    auto stage(ddf replacement) -> std::shared_future<util::Result<void>>;
+
+    /// \brief Swaps in a staged graph if it has finished compiling. Called by 'tick'.
+    ///        Returns true if the graph was replaced.
+    auto apply_staged() -> bool;
+
+    /// \brief The number of times a staged graph has been swapped in
+    auto swap_count() const -> std::uint64_t;
+
+    /// \brief Keeps the current plan alive while it is inspected, possibly from another thread
+    auto pin() const -> PinnedPlan;
+
+    /// \brief Old plans waiting for pinned readers to finish before they are destroyed
+    auto pending_reclamation() const -> std::size_t;
+
+    /// \brief Starts recording per-node execution times, tick timing and cross-region queue
+    ///        depths. The last 'trace_capacity' node executions per worker are also kept as a
+    ///        trace. Does nothing unless the library is built with LTB_DDF_ENABLE_PROFILING.
+    auto enable_profiling(std::size_t trace_capacity = 0u) -> ddf&;
+    auto disable_profiling() -> ddf&;
+
+    /// \brief The collected statistics or null if profiling is disabled
+    auto profiler() const -> Profiler const*;
+
+    /// \brief Writes the collected statistics as a binary dump (see 'Profiler::write_binary')
+    auto write_profile(std::ostream& out) const -> void;
+
+    /// \brief Runs every node once in topological order. The graph must be compiled.
+    auto tick() -> void;
+
+    /// \brief Runs every node once, executing independent nodes concurrently on 'executor'
+    auto tick(ParallelExecutor& executor) -> void;
+
+    /// \brief The value produced by an output during the last tick. The graph must be compiled.
+    ///        Throws if a staged swap replaced the graph and 'port' no longer names such an output.
+    template <typename T>
+    auto value(OutputPort<T> const& port) const -> T const&;
+
+    /// \brief Preallocates storage for 'node_count' nodes
+    auto reserve(std::size_t node_count) -> void;
+
+    auto node_count() const -> std::size_t;
+    auto node_name(NodeId node) const -> std::string const&;
+    auto nodes() const -> std::vector<NodeSpec> const&;
+
+    /// \brief The compiled plan. The graph must be compiled.
+    auto plan() const -> ExecutionPlan const&;
+
+private:
+    struct HotSwap;
+
+    auto add_node_spec(NodeSpec spec) -> NodeId;
+    auto node_arena() -> Arena&;
+    auto hot_swap() -> HotSwap&;
+    auto replace_plan(std::unique_ptr<ExecutionPlan> plan) -> void;
+
+    template <typename Run>
+    auto profiled_tick(Run&& run) -> void;
+    auto compiled_plan() const -> ExecutionPlan&;
+
+    template <typename... Ts>
+    auto connect_inputs(NodeId node, OutputPort<Ts> const&... inputs) -> void;
+
+    std::unique_ptr<Arena>         node_arena_; ///< Storage for every node body. Must outlive 'nodes_'.
+    std::vector<NodeSpec>          nodes_; ///< Every node in the graph indexed by NodeId
+    std::unique_ptr<ExecutionPlan> plan_; ///< The compiled plan or null if the graph changed
+    EvaluationMode                 mode_ = EvaluationMode::Full; ///< Applied to every compiled plan
+    bool                           fuse_chains_ = true; ///< Passed to every compile
+    std::unique_ptr<Profiler>      profiler_; ///< Null unless profiling is enabled
+    std::unique_ptr<HotSwap>       hot_swap_; ///< Staged replacement and retired plans
+};
+
+template <typename... Ins, typename... Outs, typename Body>
+auto ddf::add_node(std::string name, Inputs<Ins...>, Outputs<Outs...>, Body&& body)
+    -> Node<Inputs<Ins...>, Outputs<Outs...>> {
+    static_assert(std::is_invocable_v<std::decay_t<Body>&, NodeContext&>, "Node bodies must accept a NodeContext&");
+
+    auto id = add_node_spec({std::move(name),
+                             {&type_ops<Ins>()...},
+                             {&type_ops<Outs>()...},
+                             std::vector<PortRef>(sizeof...(Ins)),
+                             NodeBody(node_arena(), std::forward<Body>(body))});
+    return Node<Inputs<Ins...>, Outputs<Outs...>>(id);
+}
+
+template <typename Func>
+auto ddf::add_source(std::string name, Func&& func) -> OutputPort<std::decay_t<std::invoke_result_t<Func&>>> {
+    using T = std::decay_t<std::invoke_result_t<Func&>>;
+
+    auto node = add_node(std::move(name),
+                         Inputs<>{},
+                         Outputs<T>{},
+                         [func = std::forward<Func>(func)](NodeContext& ctx) mutable {
+                             ctx.set_output<T>(0, func());
+                         });
+    return node.template output<0>();
+}
+
+template <typename Func, typename... Ts>
+auto ddf::add_transform(std::string name, Func&& func, OutputPort<Ts> const&... inputs)
+    -> OutputPort<std::decay_t<std::invoke_result_t<Func&, Ts const&...>>> {
+    using T = std::decay_t<std::invoke_result_t<Func&, Ts const&...>>;
+
+    auto node = add_node(std::move(name),
+                         Inputs<Ts...>{},
+                         Outputs<T>{},
+                         [func = std::forward<Func>(func)](NodeContext& ctx) mutable {
+                             ctx.set_output<T>(
+                                 0, detail::invoke_with_inputs<Ts...>(func, ctx, std::index_sequence_for<Ts...>{}));
+                         });
+    connect_inputs(node.id(), inputs...);
+    return node.template output<0>();
+}
+
+template <typename Func, typename... Ts>
+auto ddf::add_async_transform(std::string name, Func&& func, OutputPort<Ts> const&... inputs)
+    -> OutputPort<typename std::decay_t<std::invoke_result_t<Func&, Ts const&...>>::value_type> {
+    using Pending = std::decay_t<std::invoke_result_t<Func&, Ts const&...>>;
+    using T       = typename Pending::value_type;
+    static_assert(detail::is_async<Pending>::value, "Async transforms must return an Async");
+
+    auto node = add_node(
+        std::move(name),
+        Inputs<Ts...>{},
+        Outputs<T>{},
+        [func = std::forward<Func>(func), pending = Pending(), started = std::optional<std::uint64_t>()](
+            NodeContext& ctx) mutable {
+            if (pending.poll()) {
+                ctx.set_output<T>(0, pending.take());
+            }
+
+            // Only one call is in flight at a time. Inputs that change while it runs start a new one afterwards.
+            if (!pending.valid()) {
+                auto const latest = detail::latest_input_version(ctx, sizeof...(Ts));
+
+                if (!started || latest > *started) {
+                    started = latest;
+                    pending = detail::invoke_with_inputs<Ts...>(func, ctx, std::index_sequence_for<Ts...>{});
+
+                    if (pending.poll()) {
+                        ctx.set_output<T>(0, pending.take());
+                    }
+                }
+            }
+
+            if (pending.valid()) {
+                ctx.wake_next_tick();
+            }
+        });
+    connect_inputs(node.id(), inputs...);
+    return node.template output<0>();
+}
+
+template <typename Func, typename T, typename... Ts>
+auto ddf::add_memoized_transform(std::string                          name,
+                                 std::shared_ptr<MemoCache<T(Ts...)>> cache,
+                                 Func&&                               func,
+                                 OutputPort<Ts> const&... inputs) -> OutputPort<T> {
+    if (!cache) {
+        throw std::invalid_argument("Memoized transforms need a cache");
+    }
+
+    auto node = add_node(std::move(name),
+                         Inputs<Ts...>{},
+                         Outputs<T>{},
+                         [func = std::forward<Func>(func), cache = std::move(cache)](NodeContext& ctx) mutable {
+                             auto lookup = [&](Ts const&... args) -> T {
+                                 return cache->get_or_compute(func, args...);
+                             };
+                             ctx.set_output<T>(
+                                 0, detail::invoke_with_inputs<Ts...>(lookup, ctx, std::index_sequence_for<Ts...>{}));
+                         });
+    connect_inputs(node.id(), inputs...);
+    return node.template output<0>();
+}
+
+template <typename Func, typename... Ts>
+auto ddf::add_sink(std::string name, Func&& func, OutputPort<Ts> const&... inputs) -> NodeId {
+    auto node = add_node(std::move(name),
+                         Inputs<Ts...>{},
+                         Outputs<>{},
+                         [func = std::forward<Func>(func)](NodeContext& ctx) mutable {
+                             detail::invoke_with_inputs<Ts...>(func, ctx, std::index_sequence_for<Ts...>{});
+                         });
+    connect_inputs(node.id(), inputs...);
+    return node.id();
+}
+
+template <typename T, typename Func>
+auto ddf::add_event_source(std::string name, Func&& func) -> OutputPort<EventBuffer<T>> {
+    auto node = add_node(std::move(name),
+                         Inputs<>{},
+                         Outputs<EventBuffer<T>>{},
+                         [func = std::forward<Func>(func)](NodeContext& ctx) mutable {
+                             func(ctx.event_output<T>(0));
+                         });
+    return node.template output<0>();
+}
+
+template <typename R, typename Func, typename T>
+auto ddf::add_event_transform(std::string name, Func&& func, OutputPort<EventBuffer<T>> const& input)
+    -> OutputPort<EventBuffer<R>> {
+    auto node = add_node(std::move(name),
+                         Inputs<EventBuffer<T>>{},
+                         Outputs<EventBuffer<R>>{},
+                         [func = std::forward<Func>(func)](NodeContext& ctx) mutable {
+                             auto events = ctx.events<T>(0);
+                             if (!events.empty()) {
+                                 func(events, ctx.event_output<R>(0));
+                             }
+                         });
+    connect_inputs(node.id(), input);
+    return node.template output<0>();
+}
+
+template <typename Func, typename T>
+auto ddf::add_event_sink(std::string name, Func&& func, OutputPort<EventBuffer<T>> const& input) -> NodeId {
+    auto node = add_node(std::move(name),
+                         Inputs<EventBuffer<T>>{},
+                         Outputs<>{},
+                         [func = std::forward<Func>(func)](NodeContext& ctx) mutable {
+                             auto events = ctx.events<T>(0);
+                             if (!events.empty()) {
+                                 func(events);
+                             }
+                         });
+    connect_inputs(node.id(), input);
+    return node.id();
+}
+
+template <typename T>
+auto ddf::connect(OutputPort<T> const& from, InputPort<T> const& to) -> util::Result<void> {
+    return connect(PortRef(from), PortRef(to));
+}
+
+template <typename T>
+auto ddf::value(OutputPort<T> const& port) const -> T const& {
+    return compiled_plan().value(port);
+}
+
+template <typename... Ts>
+auto ddf::connect_inputs([[maybe_unused]] NodeId node, OutputPort<Ts> const&... inputs) -> void {
+    [[maybe_unused]] auto index = PortIndex{0u};
+    ((nodes_[node].input_sources[index++] = inputs), ...);
+}
 
 } // namespace ltb::ddf
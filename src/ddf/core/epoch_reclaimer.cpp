@@ -0,0 +1,177 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "epoch_reclaimer.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+namespace ltb::ddf {
+
+EpochReclaimer::Guard::~Guard() {
+    if (slot_) {
+        slot_->store(0u, std::memory_order_release);
+    }
+}
+
+EpochReclaimer::Guard::Guard(Guard&& other) noexcept : slot_(std::exchange(other.slot_, nullptr)) {}
+
+auto EpochReclaimer::Guard::operator=(Guard&& other) noexcept -> Guard& {
+    if (this != &other) {
+        if (slot_) {
+            slot_->store(0u, std::memory_order_release);
+        }
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+EpochReclaimer::EpochReclaimer() {
+    for (auto& reader : readers_) {
+        reader.store(0u, std::memory_order_relaxed);
+    }
+}
+
+EpochReclaimer::~EpochReclaimer() = default;
+
+auto EpochReclaimer::enter() -> Guard {
+    while (true) {
+        for (auto& reader : readers_) {
+            auto expected = std::uint64_t{0u};
+
+            // Sequentially consistent so the epoch is visible before the reader loads any
+            // pointer, and any retire that happens after sees this reader.
+            if (reader.load(std::memory_order_relaxed) == 0u
+                && reader.compare_exchange_strong(expected, epoch_.load(std::memory_order_seq_cst))) {
+                return Guard(&reader);
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+auto EpochReclaimer::retire(std::shared_ptr<void> object) -> void {
+    auto const epoch = epoch_.fetch_add(1u, std::memory_order_seq_cst);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    retired_.push_back({epoch, std::move(object)});
+}
+
+auto EpochReclaimer::collect() -> std::size_t {
+    // Readers that entered at or before an object's retire epoch may still be using it
+    auto oldest_reader = epoch_.load(std::memory_order_seq_cst);
+
+    for (auto const& reader : readers_) {
+        auto const epoch = reader.load(std::memory_order_seq_cst);
+        if (epoch != 0u) {
+            oldest_reader = std::min(oldest_reader, epoch);
+        }
+    }
+
+    std::vector<Retired> reclaimable;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto split = std::partition(retired_.begin(), retired_.end(), [oldest_reader](auto const& retired) {
+            return retired.epoch >= oldest_reader;
+        });
+        std::move(split, retired_.end(), std::back_inserter(reclaimable));
+        retired_.erase(split, retired_.end());
+    }
+
+    // Destroyed outside the lock
+    return reclaimable.size();
+}
+
+auto EpochReclaimer::pending() const -> std::size_t {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+}
+
+TEST_CASE("[ltb][ddf] epoch reclaimer waits for readers") {
+    EpochReclaimer reclaimer;
+
+    auto object = std::make_shared<int>(3);
+    auto weak   = std::weak_ptr<int>(object);
+
+    auto old_reader = std::make_unique<EpochReclaimer::Guard>(reclaimer.enter());
+
+    reclaimer.retire(std::move(object));
+    CHECK(reclaimer.pending() == 1u);
+
+    // A reader that entered after the retire cannot see the object
+    auto new_reader = reclaimer.enter();
+
+    CHECK(reclaimer.collect() == 0u);
+    CHECK_FALSE(weak.expired());
+
+    old_reader.reset();
+    CHECK(reclaimer.collect() == 1u);
+    CHECK(weak.expired());
+    CHECK(reclaimer.pending() == 0u);
+}
+
+TEST_CASE("[ltb][ddf] epoch reclaimer across threads") {
+    EpochReclaimer   reclaimer;
+    std::atomic<int*> published{new int(0)};
+    std::atomic_bool done{false};
+    std::atomic_bool monotonic{true};
+
+    std::vector<std::thread> readers;
+    for (auto r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            auto last = 0;
+            while (!done) {
+                auto guard = reclaimer.enter();
+                auto value = *published.load();
+                if (value < last) {
+                    monotonic = false;
+                }
+                last = value;
+            }
+        });
+    }
+
+    for (auto i = 1; i <= 200; ++i) {
+        auto* previous = published.exchange(new int(i));
+        reclaimer.retire(std::shared_ptr<int>(previous));
+        reclaimer.collect();
+    }
+
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    reclaimer.collect();
+    CHECK(monotonic);
+    CHECK(reclaimer.pending() == 0u);
+    delete published.load();
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,101 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ltb::ddf {
+
+/**
+ * @brief Epoch-based reclamation for objects that other threads may still be reading.
+ *
+ * Readers 'enter' before loading a shared pointer and hold the returned guard for as long
+ * as they use the object. A writer publishes a replacement and then 'retire's the old
+ * object, which is destroyed by 'collect' once every reader that could have seen it has
+ * left. Entering and leaving are a handful of atomic operations and never block writers.
+ */
+class EpochReclaimer {
+public:
+    static constexpr std::size_t max_readers = 64u;
+
+    /// \brief Marks the calling thread as reading until destroyed
+    class Guard {
+    public:
+        Guard() = default;
+        ~Guard();
+
+        Guard(Guard const&) = delete;
+        auto operator=(Guard const&) -> Guard& = delete;
+
+        Guard(Guard&& other) noexcept;
+        auto operator=(Guard&& other) noexcept -> Guard&;
+
+    private:
+        friend class EpochReclaimer;
+        explicit Guard(std::atomic<std::uint64_t>* slot) : slot_(slot) {}
+
+        std::atomic<std::uint64_t>* slot_ = nullptr;
+    };
+
+    EpochReclaimer();
+    ~EpochReclaimer();
+
+    EpochReclaimer(EpochReclaimer const&) = delete;
+    EpochReclaimer(EpochReclaimer&&)      = delete;
+    auto operator=(EpochReclaimer const&) -> EpochReclaimer& = delete;
+    auto operator=(EpochReclaimer&&) -> EpochReclaimer& = delete;
+
+    /// \brief Starts a read. Waits if 'max_readers' reads are already active.
+    auto enter() -> Guard;
+
+    /// \brief Destroys 'object' once no reader that entered before this call is still active.
+    ///        The replacement must already be published when this is called.
+    auto retire(std::shared_ptr<void> object) -> void;
+
+    /// \brief Destroys every retired object that can no longer be read. Returns how many were destroyed.
+    auto collect() -> std::size_t;
+
+    /// \brief The number of retired objects waiting to be destroyed
+    auto pending() const -> std::size_t;
+
+private:
+    struct Retired {
+        std::uint64_t         epoch;
+        std::shared_ptr<void> object;
+    };
+
+    std::atomic<std::uint64_t> epoch_{1u}; ///< Advanced every time an object is retired
+    std::array<std::atomic<std::uint64_t>, max_readers> readers_; ///< Epoch each active reader entered at (0 if free)
+
+    mutable std::mutex   mutex_;
+    std::vector<Retired> retired_;
+};
+
+} // namespace ltb::ddf
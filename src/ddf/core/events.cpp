@@ -0,0 +1,133 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "events.hpp"
+
+// project
+#include "ddf.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <array>
+
+namespace ltb::ddf {
+
+TEST_CASE("[ltb][ddf] batched events") {
+    ddf graph;
+
+    auto samples  = std::vector<float>{};
+    auto batches  = 0;
+    auto received = std::vector<float>{};
+
+    auto source = graph.add_event_source<float>(
+        "samples", [&samples](EventBuffer<float>& events) { events.fire(samples); });
+
+    auto scaled = graph.add_event_transform<float>(
+        "scale",
+        [](Span<float const> in, EventBuffer<float>& out) {
+            for (auto value : in) {
+                out.fire(value * 2.f);
+            }
+        },
+        source);
+
+    graph.add_event_sink(
+        "collect",
+        [&](Span<float const> events) {
+            ++batches;
+            received.insert(received.end(), events.begin(), events.end());
+        },
+        scaled);
+
+    REQUIRE(graph.compile());
+
+    samples = {1.f, 2.f, 3.f};
+    graph.tick();
+    CHECK(batches == 1);
+    CHECK(received == std::vector<float>{2.f, 4.f, 6.f});
+
+    // Empty batches don't reach the sink and previous events are not delivered twice
+    samples.clear();
+    graph.tick();
+    CHECK(batches == 1);
+
+    samples = {4.f};
+    graph.tick();
+    CHECK(batches == 2);
+    CHECK(received == std::vector<float>{2.f, 4.f, 6.f, 8.f});
+    CHECK(graph.value(scaled).events().size() == 1u);
+}
+
+TEST_CASE("[ltb][ddf] event batches fire from containers and spans") {
+    auto buffer = EventBuffer<float>{};
+    buffer.begin_tick(1u);
+
+    auto       values       = std::vector<float>{1.f, 2.f};
+    auto const const_values = std::vector<float>{3.f};
+    auto       more         = std::array<float, 2>{4.f, 5.f};
+
+    buffer.fire(values);
+    buffer.fire(const_values);
+    buffer.fire(Span<float>(more));
+    buffer.fire(6);
+
+    auto const events = buffer.events();
+    CHECK(std::vector<float>(events.begin(), events.end()) == std::vector<float>{1.f, 2.f, 3.f, 4.f, 5.f, 6.f});
+}
+
+TEST_CASE("[ltb][ddf] stale events are ignored when the producer is skipped") {
+    ddf graph;
+    graph.set_evaluation_mode(EvaluationMode::Incremental);
+
+    auto fire   = true;
+    auto state  = 0;
+    auto counts = std::vector<std::size_t>{};
+
+    auto events = graph.add_event_source<int>("events", [&fire](EventBuffer<int>& buffer) {
+        if (fire) {
+            buffer.fire(1);
+        }
+    });
+    auto relay = graph.add_event_transform<int>(
+        "relay", [](Span<int const> in, EventBuffer<int>& out) { out.fire(Span<int const>(in)); }, events);
+    auto value = graph.add_source("state", [&state] { return state; });
+
+    auto count = graph.add_node("count", Inputs<EventBuffer<int>, int>{}, Outputs<>{}, [&counts](NodeContext& ctx) {
+        counts.push_back(ctx.events<int>(0).size());
+    });
+    REQUIRE(graph.connect(relay, count.input<0>()));
+    REQUIRE(graph.connect(value, count.input<1>()));
+
+    REQUIRE(graph.compile());
+
+    graph.tick();
+    fire = false;
+    graph.tick(); // 'relay' runs but fires nothing so 'count' is skipped
+    state = 1;
+    graph.tick(); // 'count' runs because 'state' changed but the old event is not re-delivered
+
+    CHECK(counts == std::vector<std::size_t>{1u, 0u});
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,105 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief A non-owning view of a contiguous sequence of values
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(T* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename Container, typename = decltype(std::declval<Container&>().data())>
+    Span(Container& container) // NOLINT(google-explicit-constructor)
+        : data_(container.data()), size_(container.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<T, U const>>>
+    Span(Span<U> const& other) : data_(other.data()), size_(other.size()) {} // NOLINT(google-explicit-constructor)
+
+    auto data() const -> T* { return data_; }
+    auto size() const -> std::size_t { return size_; }
+    auto empty() const -> bool { return size_ == 0u; }
+
+    auto begin() const -> T* { return data_; }
+    auto end() const -> T* { return data_ + size_; }
+
+    auto operator[](std::size_t index) const -> T& { return data_[index]; }
+
+private:
+    T*          data_ = nullptr;
+    std::size_t size_ = 0u;
+};
+
+/**
+ * @brief The value stored in an event port: every event fired by a node during one tick.
+ *
+ * Events are appended to one contiguous buffer so downstream nodes receive the whole
+ * batch in a single call and can process it with tight (vectorizable) loops. The buffer
+ * is stamped with the tick it was filled on and cleared (keeping its capacity) the next
+ * time the producing node runs, so steady-state ticks don't allocate.
+ */
+template <typename T>
+class EventBuffer {
+public:
+    /// \brief Appends a single event. Only used for values that construct a 'T' so containers
+    ///        and spans of events pick the batch overload below.
+    template <typename U, typename = std::enable_if_t<std::is_constructible_v<T, U&&>>>
+    auto fire(U&& event) -> void {
+        events_.emplace_back(std::forward<U>(event));
+    }
+
+    /// \brief Appends a batch of events
+    auto fire(Span<T const> events) -> void { events_.insert(events_.end(), events.begin(), events.end()); }
+
+    /// \brief Every event fired during the tick this buffer was filled on
+    auto events() const -> Span<T const> { return {events_.data(), events_.size()}; }
+
+    /// \brief Pre-allocates room for 'capacity' events per tick
+    auto reserve(std::size_t capacity) -> void { events_.reserve(capacity); }
+
+    /// \brief The tick the events were fired on
+    auto tick() const -> std::uint64_t { return tick_; }
+
+    /// \brief Clears the events fired on previous ticks. Called before a producer fires new events.
+    auto begin_tick(std::uint64_t tick) -> void {
+        if (tick_ != tick) {
+            events_.clear();
+            tick_ = tick;
+        }
+    }
+
+private:
+    std::vector<T> events_;
+    std::uint64_t  tick_ = 0u;
+};
+
+} // namespace ltb::ddf
@@ -0,0 +1,429 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "execution_plan.hpp"
+
+// standard
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace ltb::ddf {
+namespace {
+
+auto align_up(std::size_t offset, std::size_t alignment) -> std::size_t {
+    return (offset + alignment - 1u) / alignment * alignment;
+}
+
+auto port_error(std::string const& message, NodeSpec const& node, PortIndex index) -> util::Error {
+    return LTB_MAKE_ERROR(message + " (node '" + node.name + "', port " + std::to_string(index) + ")");
+}
+
+} // namespace
+
+ExecutionPlan::ExecutionPlan() : slots_(nullptr, SlotBufferDeleter{alignof(std::max_align_t)}) {
+    reserve_workers(1u);
+}
+
+ExecutionPlan::~ExecutionPlan() {
+    if (slots_) {
+        for (auto i = 0u; i < slot_types_.size(); ++i) {
+            slot_types_[i]->destroy(slots_.get() + output_offsets_[i]);
+        }
+    }
+}
+
+auto ExecutionPlan::compile(std::vector<NodeSpec>& nodes, Arena& body_arena, bool fuse_chains)
+    -> util::Result<std::unique_ptr<ExecutionPlan>> {
+    auto const node_count = nodes.size();
+
+    // Validate every connection and build a compressed successor list for each node.
+    std::vector<std::size_t> successor_begin(node_count + 1u, 0u);
+    std::vector<std::size_t> in_degree(node_count, 0u);
+
+    auto output_count = std::size_t{0u};
+
+    for (auto const& node : nodes) {
+        output_count += node.output_types.size();
+
+        for (auto i = 0u; i < node.input_sources.size(); ++i) {
+            auto const& source = node.input_sources[i];
+
+            if (source.node == invalid_node) {
+                return tl::make_unexpected(port_error("Input is not connected", node, i));
+            }
+            if (source.node >= node_count || source.index >= nodes[source.node].output_types.size()) {
+                return tl::make_unexpected(port_error("Input is connected to an invalid output", node, i));
+            }
+            if (!same_type(*nodes[source.node].output_types[source.index], *node.input_types[i])) {
+                return tl::make_unexpected(port_error("Input is connected to an output of a different type", node, i));
+            }
+            ++successor_begin[source.node + 1u];
+        }
+    }
+
+    for (auto n = 0u; n < node_count; ++n) {
+        successor_begin[n + 1u] += successor_begin[n];
+    }
+
+    std::vector<NodeId>      successors(successor_begin.back());
+    std::vector<std::size_t> successor_fill(successor_begin.begin(), successor_begin.end() - 1);
+
+    for (auto n = 0u; n < node_count; ++n) {
+        for (auto const& source : nodes[n].input_sources) {
+            successors[successor_fill[source.node]++] = static_cast<NodeId>(n);
+            ++in_degree[n];
+        }
+    }
+
+    // Kahn's algorithm. Seeding in id order keeps the resulting schedule deterministic.
+    auto plan = std::unique_ptr<ExecutionPlan>(new ExecutionPlan());
+    plan->order_.reserve(node_count);
+
+    for (auto n = 0u; n < node_count; ++n) {
+        if (in_degree[n] == 0u) {
+            plan->order_.emplace_back(static_cast<NodeId>(n));
+        }
+    }
+
+    for (auto i = 0u; i < plan->order_.size(); ++i) {
+        auto const node = plan->order_[i];
+
+        for (auto s = successor_begin[node]; s < successor_begin[node + 1u]; ++s) {
+            if (--in_degree[successors[s]] == 0u) {
+                plan->order_.emplace_back(successors[s]);
+            }
+        }
+    }
+
+    if (plan->order_.size() != node_count) {
+        auto cycle_node = std::find_if(in_degree.begin(), in_degree.end(), [](auto degree) { return degree > 0u; });
+        auto const& name = nodes[static_cast<std::size_t>(std::distance(in_degree.begin(), cycle_node))].name;
+        return tl::make_unexpected(LTB_MAKE_ERROR("Graph contains a cycle through node '" + name + "'"));
+    }
+
+    // A node whose only input is the only reader of its source continues that source's chain.
+    // Emitting each chain right after its head keeps the order topological since every other
+    // member depends only on the member before it.
+    std::vector<NodeId> next_in_chain(node_count, invalid_node);
+    std::vector<bool>   continues_chain(node_count, false);
+
+    if (fuse_chains) {
+        for (auto n = 0u; n < node_count; ++n) {
+            auto const& sources = nodes[n].input_sources;
+
+            if (sources.size() != 1u) {
+                continue;
+            }
+            if (auto const source = sources[0].node; successor_begin[source + 1u] - successor_begin[source] == 1u) {
+                next_in_chain[source] = static_cast<NodeId>(n);
+                continues_chain[n]    = true;
+            }
+        }
+
+        auto sorted = std::move(plan->order_);
+        plan->order_.clear();
+        plan->order_.reserve(node_count);
+
+        for (auto const head : sorted) {
+            if (continues_chain[head]) {
+                continue;
+            }
+            plan->units_.push_back({plan->order_.size(), 0u});
+
+            for (auto node = head; node != invalid_node; node = next_in_chain[node]) {
+                plan->order_.emplace_back(node);
+            }
+            plan->units_.back().step_end = plan->order_.size();
+        }
+    } else {
+        for (auto i = 0u; i < node_count; ++i) {
+            plan->units_.push_back({i, i + 1u});
+        }
+    }
+
+    // Lay out every output slot and node body contiguously in execution order.
+    auto buffer_size      = std::size_t{0u};
+    auto buffer_alignment = alignof(std::max_align_t);
+
+    plan->node_output_begin_.resize(node_count);
+    plan->node_output_count_.resize(node_count);
+    plan->steps_.reserve(node_count);
+    plan->bodies_.reserve(node_count);
+    plan->output_offsets_.reserve(output_count);
+    plan->slot_types_.reserve(output_count);
+    plan->input_offsets_.reserve(successors.size());
+    plan->input_slots_.reserve(successors.size());
+
+    for (auto const node_id : plan->order_) {
+        auto& node = nodes[node_id];
+
+        plan->node_output_begin_[node_id] = plan->output_offsets_.size();
+        plan->node_output_count_[node_id] = node.output_types.size();
+        plan->steps_.push_back({node_id, 0u, plan->output_offsets_.size()});
+        node.body.relocate(body_arena);
+        plan->bodies_.emplace_back(&node.body);
+
+        for (auto const* type : node.output_types) {
+            buffer_size = align_up(buffer_size, type->alignment);
+            plan->output_offsets_.emplace_back(buffer_size);
+            plan->slot_types_.emplace_back(type);
+
+            buffer_size += type->size;
+            buffer_alignment = std::max(buffer_alignment, type->alignment);
+        }
+    }
+
+    // Resolve each input to the slot of the output it reads from.
+    for (auto& step : plan->steps_) {
+        step.input_begin = plan->input_offsets_.size();
+
+        for (auto const& source : nodes[step.node].input_sources) {
+            auto const slot = plan->node_output_begin_[source.node] + source.index;
+            plan->input_slots_.emplace_back(slot);
+            plan->input_offsets_.emplace_back(plan->output_offsets_[slot]);
+        }
+    }
+
+    plan->output_versions_.resize(plan->output_offsets_.size(), 0u);
+    plan->step_last_run_.resize(node_count, 0u);
+    plan->step_wake_.resize(node_count, 0u);
+
+    // Record the dependencies between units so independent units can run concurrently. Only the
+    // head of a unit reads from other units.
+    std::vector<std::size_t> unit_of_node(node_count);
+
+    for (auto u = 0u; u < plan->units_.size(); ++u) {
+        for (auto i = plan->units_[u].step_begin; i < plan->units_[u].step_end; ++i) {
+            unit_of_node[plan->order_[i]] = u;
+        }
+    }
+
+    plan->unit_dependencies_.reserve(plan->units_.size());
+    plan->unit_successor_begin_.reserve(plan->units_.size() + 1u);
+    plan->unit_successors_.reserve(successors.size());
+
+    for (auto u = 0u; u < plan->units_.size(); ++u) {
+        auto const& unit = plan->units_[u];
+        auto const  head = plan->order_[unit.step_begin];
+
+        plan->unit_dependencies_.emplace_back(static_cast<std::uint32_t>(nodes[head].input_sources.size()));
+        plan->unit_successor_begin_.emplace_back(plan->unit_successors_.size());
+
+        for (auto i = unit.step_begin; i < unit.step_end; ++i) {
+            auto const node_id = plan->order_[i];
+
+            for (auto s = successor_begin[node_id]; s < successor_begin[node_id + 1u]; ++s) {
+                if (unit_of_node[successors[s]] != u) {
+                    plan->unit_successors_.emplace_back(unit_of_node[successors[s]]);
+                }
+            }
+        }
+    }
+    plan->unit_successor_begin_.emplace_back(plan->unit_successors_.size());
+
+    plan->slots_ = std::unique_ptr<std::byte[], SlotBufferDeleter>(
+        static_cast<std::byte*>(::operator new(std::max(buffer_size, std::size_t{1u}),
+                                               std::align_val_t{buffer_alignment})),
+        SlotBufferDeleter{buffer_alignment});
+
+    for (auto i = 0u; i < plan->slot_types_.size(); ++i) {
+        plan->slot_types_[i]->construct(plan->slots_.get() + plan->output_offsets_[i]);
+    }
+
+    return plan;
+}
+
+auto ExecutionPlan::run() -> void {
+    begin_tick();
+
+    for (auto i = 0u; i < steps_.size(); ++i) {
+        run_step(i);
+    }
+}
+
+auto ExecutionPlan::begin_tick() -> void {
+    ++tick_;
+    executed_count_.store(0u, std::memory_order_relaxed);
+
+    for (auto& scratch : scratch_) {
+        scratch->reset();
+    }
+}
+
+auto ExecutionPlan::run_unit(std::size_t unit, std::size_t worker) -> void {
+    for (auto step = units_[unit].step_begin; step < units_[unit].step_end; ++step) {
+        run_step(step, worker);
+    }
+}
+
+auto ExecutionPlan::run_step(std::size_t step, std::size_t worker) -> bool {
+    if (mode_ == EvaluationMode::Incremental && !needs_update(step)) {
+        return false;
+    }
+
+    step_wake_[step] = 0u;
+    auto ctx         = context(step, worker);
+
+    if constexpr (profiling_enabled) {
+        if (profiler_) {
+            auto const begin = profiler_->now();
+            (*bodies_[step])(ctx);
+            profiler_->record_node(steps_[step].node, worker, begin, profiler_->now());
+        } else {
+            (*bodies_[step])(ctx);
+        }
+    } else {
+        (*bodies_[step])(ctx);
+    }
+
+    step_last_run_[step] = tick_;
+    executed_count_.fetch_add(1u, std::memory_order_relaxed);
+    return true;
+}
+
+auto ExecutionPlan::reserve_workers(std::size_t worker_count) -> void {
+    while (scratch_.size() < worker_count) {
+        scratch_.emplace_back(std::make_unique<Arena>());
+    }
+    if (profiler_) {
+        profiler_->reserve_workers(worker_count);
+    }
+}
+
+auto ExecutionPlan::scratch(std::size_t worker) const -> Arena const& {
+    return *scratch_.at(worker);
+}
+
+auto ExecutionPlan::set_profiler(Profiler* profiler) -> void {
+    profiler_ = profiling_enabled ? profiler : nullptr;
+
+    if (profiler_) {
+        profiler_->resize(order_.size());
+        profiler_->reserve_workers(scratch_.size());
+    }
+}
+
+auto ExecutionPlan::set_evaluation_mode(EvaluationMode mode) -> void {
+    mode_ = mode;
+}
+
+auto ExecutionPlan::evaluation_mode() const -> EvaluationMode {
+    return mode_;
+}
+
+auto ExecutionPlan::executed_count() const -> std::size_t {
+    return executed_count_.load(std::memory_order_relaxed);
+}
+
+auto ExecutionPlan::steps() const -> std::vector<ExecutionStep> const& {
+    return steps_;
+}
+
+auto ExecutionPlan::execution_order() const -> std::vector<NodeId> const& {
+    return order_;
+}
+
+auto ExecutionPlan::units() const -> std::vector<ExecutionUnit> const& {
+    return units_;
+}
+
+auto ExecutionPlan::fused_chains() const -> std::vector<std::vector<NodeId>> {
+    auto chains = std::vector<std::vector<NodeId>>();
+
+    for (auto const& unit : units_) {
+        if (unit.step_end - unit.step_begin > 1u) {
+            chains.emplace_back(order_.begin() + static_cast<std::ptrdiff_t>(unit.step_begin),
+                                order_.begin() + static_cast<std::ptrdiff_t>(unit.step_end));
+        }
+    }
+    return chains;
+}
+
+auto ExecutionPlan::unit_dependencies() const -> std::vector<std::uint32_t> const& {
+    return unit_dependencies_;
+}
+
+auto ExecutionPlan::unit_successor_begin() const -> std::vector<std::size_t> const& {
+    return unit_successor_begin_;
+}
+
+auto ExecutionPlan::unit_successors() const -> std::vector<std::size_t> const& {
+    return unit_successors_;
+}
+
+auto ExecutionPlan::context(std::size_t step, std::size_t worker) -> NodeContext {
+    auto const& info = steps_[step];
+    return {slots_.get(),
+            input_offsets_.data() + info.input_begin,
+            output_offsets_.data() + info.output_begin,
+            output_versions_.data() + info.output_begin,
+            output_versions_.data(),
+            input_slots_.data() + info.input_begin,
+            &step_wake_[step],
+            tick_,
+            mode_ == EvaluationMode::Incremental,
+            scratch_[worker].get(),
+            profiler_};
+}
+
+auto ExecutionPlan::needs_update(std::size_t step) const -> bool {
+    auto const last_run    = step_last_run_[step];
+    auto const input_begin = steps_[step].input_begin;
+    auto const input_end   = step + 1u < steps_.size() ? steps_[step + 1u].input_begin : input_slots_.size();
+
+    // Sources have nothing to compare against so they always run, as does a step that never ran
+    // or one that is waiting on asynchronous work.
+    if (input_begin == input_end || last_run == 0u || step_wake_[step] != 0u) {
+        return true;
+    }
+
+    for (auto i = input_begin; i < input_end; ++i) {
+        if (output_versions_[input_slots_[i]] > last_run) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto ExecutionPlan::output_slot(PortRef const& port, TypeOps const& type) const -> std::byte const* {
+    // Ports are plain indices so one kept across a hot swap may not exist in this plan
+    if (port.node >= node_output_count_.size() || port.index >= node_output_count_[port.node]) {
+        throw std::out_of_range("Output " + std::to_string(port.index) + " of node " + std::to_string(port.node)
+                                + " does not exist in the current plan");
+    }
+
+    auto const slot = node_output_begin_[port.node] + port.index;
+    if (*slot_types_[slot]->type != *type.type) {
+        throw std::invalid_argument("Output " + std::to_string(port.index) + " of node " + std::to_string(port.node)
+                                    + " holds '" + slot_types_[slot]->type_name() + "', not '" + type.type_name()
+                                    + "'");
+    }
+    return slots_.get() + output_offsets_[slot];
+}
+
+auto ExecutionPlan::SlotBufferDeleter::operator()(std::byte* ptr) const -> void {
+    ::operator delete(ptr, std::align_val_t{alignment});
+}
+
+} // namespace ltb::ddf
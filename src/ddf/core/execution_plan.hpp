@@ -0,0 +1,183 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "node_context.hpp"
+#include "node_spec.hpp"
+#include "ports.hpp"
+#include "ltb/util/result.hpp"
+
+// standard
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief A single node invocation in a compiled plan
+struct ExecutionStep {
+    NodeId      node;
+    std::size_t input_begin; ///< First entry for this node in the plan's input offsets
+    std::size_t output_begin; ///< First entry for this node in the plan's output offsets
+};
+
+/// \brief Consecutive steps that are always scheduled together. A unit of more than one step
+///        is a fused chain where each step only reads the outputs of the step before it.
+struct ExecutionUnit {
+    std::size_t step_begin;
+    std::size_t step_end;
+};
+
+/**
+ * @brief A flat, topologically sorted schedule of node invocations.
+ *
+ * Every output port is assigned a slot in one contiguous buffer (laid out in execution
+ * order) and every input is resolved to the offset of the slot it reads from, so running
+ * the plan is a single loop over contiguous arrays with one call per node.
+ *
+ * Compiling also relocates every node body into the supplied arena in execution order,
+ * and the plan keeps one scratch arena per worker that node bodies can use for temporaries.
+ *
+ * Linear chains, where a node's only input comes from a node that has no other readers,
+ * are fused into a single ExecutionUnit. The chain's steps (and output slots) are laid out
+ * back to back and a ParallelExecutor dispatches the whole chain as one task, so a long
+ * pipeline costs one scheduling hop instead of one per node. Each node still has its own
+ * step, so values, incremental evaluation and profiling are unaffected.
+ */
+class ExecutionPlan {
+public:
+    /// \brief Sorts and lays out 'nodes'. Fails if the graph has cycles or unconnected inputs.
+    ///        On success every node body has been relocated into 'body_arena' in execution order.
+    ///        Linear chains are fused into single units unless 'fuse_chains' is false.
+    static auto compile(std::vector<NodeSpec>& nodes, Arena& body_arena, bool fuse_chains = true)
+        -> util::Result<std::unique_ptr<ExecutionPlan>>;
+
+    ~ExecutionPlan();
+
+    ExecutionPlan(ExecutionPlan const&) = delete;
+    ExecutionPlan(ExecutionPlan&&)      = delete;
+    auto operator=(ExecutionPlan const&) -> ExecutionPlan& = delete;
+    auto operator=(ExecutionPlan&&) -> ExecutionPlan& = delete;
+
+    /// \brief Execute every node once in topological order
+    auto run() -> void;
+
+    /// \brief Advance the tick counter and reset the scratch arenas. Must be called once before
+    ///        the steps of a tick are run.
+    auto begin_tick() -> void;
+
+    /// \brief Execute the steps of 'unit' in order. Like 'run', a step that throws stops the unit.
+    auto run_unit(std::size_t unit, std::size_t worker = 0u) -> void;
+
+    /// \brief Execute a single step of the plan. In incremental mode the step is skipped if none
+    ///        of its inputs changed since it last ran. Returns true if the node was executed.
+    ///        'worker' selects the scratch arena handed to the node body.
+    auto run_step(std::size_t step, std::size_t worker = 0u) -> bool;
+
+    /// \brief Makes sure there is a scratch arena for each of 'worker_count' concurrent workers
+    auto reserve_workers(std::size_t worker_count) -> void;
+
+    /// \brief The scratch arena used by 'worker'
+    auto scratch(std::size_t worker = 0u) const -> Arena const&;
+
+    /// \brief Times every step into 'profiler' (which may be null). Only has an effect when
+    ///        profiling is compiled in.
+    auto set_profiler(Profiler* profiler) -> void;
+
+    auto set_evaluation_mode(EvaluationMode mode) -> void;
+    auto evaluation_mode() const -> EvaluationMode;
+
+    /// \brief The number of node bodies executed during the last tick
+    auto executed_count() const -> std::size_t;
+
+    /// \brief The steps in the order they are executed
+    auto steps() const -> std::vector<ExecutionStep> const&;
+
+    /// \brief The node ids in the order they are executed
+    auto execution_order() const -> std::vector<NodeId> const&;
+
+    /// \brief The groups of steps that are scheduled together, in execution order
+    auto units() const -> std::vector<ExecutionUnit> const&;
+
+    /// \brief The node ids of every fused chain (units of more than one step)
+    auto fused_chains() const -> std::vector<std::vector<NodeId>>;
+
+    /// \brief The number of inputs from other units each unit waits on before it can run
+    auto unit_dependencies() const -> std::vector<std::uint32_t> const&;
+
+    /// \brief The units reading unit 'u' outputs are in 'unit_successors()' from
+    ///        'unit_successor_begin()[u]' up to 'unit_successor_begin()[u + 1]'
+    auto unit_successor_begin() const -> std::vector<std::size_t> const&;
+    auto unit_successors() const -> std::vector<std::size_t> const&;
+
+    /// \brief The current value stored in an output slot. Throws if 'port' does not name an
+    ///        output of type T in this plan, e.g. a port kept from a graph that was swapped out.
+    template <typename T>
+    auto value(OutputPort<T> const& port) const -> T const&;
+
+private:
+    ExecutionPlan();
+
+    auto context(std::size_t step, std::size_t worker) -> NodeContext;
+    auto needs_update(std::size_t step) const -> bool;
+    auto output_slot(PortRef const& port, TypeOps const& type) const -> std::byte const*;
+
+    struct SlotBufferDeleter {
+        std::size_t alignment;
+        auto        operator()(std::byte* ptr) const -> void;
+    };
+
+    std::vector<ExecutionStep>                     steps_; ///< Nodes in topological order
+    std::vector<NodeBody*>                         bodies_; ///< The body for each step (parallel to steps_)
+    std::vector<NodeId>                            order_; ///< The node id for each step
+    std::vector<std::size_t>                       input_offsets_; ///< Slot offsets read by each step's inputs
+    std::vector<std::size_t>                       output_offsets_; ///< Slot offsets written by each step's outputs
+    std::vector<std::size_t>                       input_slots_; ///< Output slot index read by each input
+    std::vector<std::uint64_t>                     output_versions_; ///< The tick each output slot last changed
+    std::vector<std::uint64_t>                     step_last_run_; ///< The tick each step last executed
+    std::vector<std::uint8_t>                      step_wake_; ///< Steps that asked to run again next tick
+    std::vector<std::size_t>                       node_output_begin_; ///< First output offset indexed by NodeId
+    std::vector<std::size_t>                       node_output_count_; ///< Number of outputs indexed by NodeId
+    std::vector<ExecutionUnit>                     units_; ///< Steps grouped into scheduling units
+    std::vector<std::uint32_t>                     unit_dependencies_; ///< External input count for each unit
+    std::vector<std::size_t>                       unit_successor_begin_; ///< Successor ranges for each unit
+    std::vector<std::size_t>                       unit_successors_; ///< Units that read each unit's outputs
+    std::vector<TypeOps const*>                    slot_types_; ///< The type stored in each output slot
+    std::unique_ptr<std::byte[], SlotBufferDeleter> slots_; ///< Contiguous storage for every output value
+    std::vector<std::unique_ptr<Arena>>             scratch_; ///< Per-tick temporary memory for each worker
+    Profiler*                                       profiler_ = nullptr; ///< Owned by the graph
+
+    EvaluationMode           mode_ = EvaluationMode::Full;
+    std::uint64_t            tick_ = 0u; ///< The current tick number (0 before the first tick)
+    std::atomic<std::size_t> executed_count_{0u}; ///< Node bodies executed this tick
+};
+
+template <typename T>
+auto ExecutionPlan::value(OutputPort<T> const& port) const -> T const& {
+    return *std::launder(reinterpret_cast<T const*>(output_slot(port, type_ops<T>())));
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,502 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "graph_file.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LTB_DDF_HAS_MMAP
+#endif
+
+namespace ltb::ddf {
+namespace {
+
+constexpr char          graph_magic[4] = {'L', 'D', 'D', 'G'};
+constexpr std::uint32_t graph_version  = 1u;
+
+struct Header {
+    char          magic[4];
+    std::uint32_t version;
+    std::uint32_t type_count;
+    std::uint32_t node_count;
+    std::uint32_t edge_count;
+    std::uint32_t string_bytes;
+    std::uint32_t param_bytes;
+};
+
+struct TypeRecord {
+    std::uint32_t name_offset;
+    std::uint32_t name_size;
+};
+
+struct NodeRecord {
+    std::uint32_t type;
+    std::uint32_t name_offset;
+    std::uint32_t name_size;
+    std::uint32_t param_offset;
+    std::uint32_t param_size;
+};
+
+struct EdgeRecord {
+    std::uint32_t from_node;
+    std::uint32_t from_port;
+    std::uint32_t to_node;
+    std::uint32_t to_port;
+};
+
+/// \brief The sections of a binary graph. Records are copied out since the data may be unaligned.
+struct GraphView {
+    Header           header;
+    std::byte const* types;
+    std::byte const* nodes;
+    std::byte const* edges;
+    char const*      strings;
+    std::byte const* params;
+
+    template <typename Record>
+    static auto record(std::byte const* records, std::size_t index) -> Record {
+        Record result;
+        std::memcpy(&result, records + index * sizeof(Record), sizeof(Record));
+        return result;
+    }
+
+    auto type(std::size_t index) const -> TypeRecord { return record<TypeRecord>(types, index); }
+    auto node(std::size_t index) const -> NodeRecord { return record<NodeRecord>(nodes, index); }
+    auto edge(std::size_t index) const -> EdgeRecord { return record<EdgeRecord>(edges, index); }
+
+    auto string(std::uint32_t offset, std::uint32_t size) const -> std::string { return {strings + offset, size}; }
+};
+
+auto view_graph(Span<std::byte const> data) -> util::Result<GraphView> {
+    GraphView view = {};
+
+    if (data.size() < sizeof(Header)) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Graph data is too small to contain a header"));
+    }
+    std::memcpy(&view.header, data.data(), sizeof(Header));
+
+    auto const& header = view.header;
+    if (!std::equal(header.magic, header.magic + 4, graph_magic)) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Not a ddf graph"));
+    }
+    if (header.version != graph_version) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Unsupported ddf graph version " + std::to_string(header.version)));
+    }
+
+    auto const expected_size = sizeof(Header) + header.type_count * sizeof(TypeRecord)
+                               + std::size_t{header.node_count} * sizeof(NodeRecord)
+                               + std::size_t{header.edge_count} * sizeof(EdgeRecord) + header.string_bytes
+                               + header.param_bytes;
+
+    if (data.size() != expected_size) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Graph data size does not match its header"));
+    }
+
+    view.types   = data.data() + sizeof(Header);
+    view.nodes   = view.types + header.type_count * sizeof(TypeRecord);
+    view.edges   = view.nodes + std::size_t{header.node_count} * sizeof(NodeRecord);
+    view.strings = reinterpret_cast<char const*>(view.edges + std::size_t{header.edge_count} * sizeof(EdgeRecord));
+    view.params  = reinterpret_cast<std::byte const*>(view.strings + header.string_bytes);
+
+    auto in_bounds = [](std::uint32_t offset, std::uint32_t size, std::uint32_t total) {
+        return std::uint64_t{offset} + size <= total;
+    };
+
+    for (auto t = 0u; t < header.type_count; ++t) {
+        auto const type = view.type(t);
+        if (!in_bounds(type.name_offset, type.name_size, header.string_bytes)) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Node type name is out of bounds"));
+        }
+    }
+
+    for (auto n = 0u; n < header.node_count; ++n) {
+        auto const node = view.node(n);
+        if (node.type >= header.type_count || !in_bounds(node.name_offset, node.name_size, header.string_bytes)
+            || !in_bounds(node.param_offset, node.param_size, header.param_bytes)) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Node " + std::to_string(n) + " is malformed"));
+        }
+    }
+
+    return view;
+}
+
+template <typename T>
+auto write_value(std::ostream& out, T const& value) -> void {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+} // namespace
+
+auto GraphDescription::add_node(std::string const& type, std::string name, std::vector<std::byte> params) -> NodeId {
+    auto iter = std::find(types.begin(), types.end(), type);
+    if (iter == types.end()) {
+        iter = types.insert(types.end(), type);
+    }
+
+    auto const type_index = static_cast<std::uint32_t>(std::distance(types.begin(), iter));
+    nodes.push_back({type_index, std::move(name), std::move(params)});
+    return static_cast<NodeId>(nodes.size() - 1u);
+}
+
+auto GraphDescription::connect(PortRef const& from, PortRef const& to) -> void {
+    edges.push_back({from, to});
+}
+
+auto write_graph(std::ostream& out, GraphDescription const& description) -> void {
+    std::string            strings;
+    std::vector<std::byte> params;
+
+    std::vector<TypeRecord> types;
+    types.reserve(description.types.size());
+
+    for (auto const& type : description.types) {
+        types.push_back({static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(type.size())});
+        strings += type;
+    }
+
+    std::vector<NodeRecord> nodes;
+    nodes.reserve(description.nodes.size());
+
+    for (auto const& node : description.nodes) {
+        nodes.push_back({node.type,
+                         static_cast<std::uint32_t>(strings.size()),
+                         static_cast<std::uint32_t>(node.name.size()),
+                         static_cast<std::uint32_t>(params.size()),
+                         static_cast<std::uint32_t>(node.params.size())});
+        strings += node.name;
+        params.insert(params.end(), node.params.begin(), node.params.end());
+    }
+
+    Header header = {{graph_magic[0], graph_magic[1], graph_magic[2], graph_magic[3]},
+                     graph_version,
+                     static_cast<std::uint32_t>(types.size()),
+                     static_cast<std::uint32_t>(nodes.size()),
+                     static_cast<std::uint32_t>(description.edges.size()),
+                     static_cast<std::uint32_t>(strings.size()),
+                     static_cast<std::uint32_t>(params.size())};
+
+    write_value(out, header);
+    for (auto const& type : types) {
+        write_value(out, type);
+    }
+    for (auto const& node : nodes) {
+        write_value(out, node);
+    }
+    for (auto const& edge : description.edges) {
+        write_value(out, EdgeRecord{edge.from.node, edge.from.index, edge.to.node, edge.to.index});
+    }
+    out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    out.write(reinterpret_cast<char const*>(params.data()), static_cast<std::streamsize>(params.size()));
+}
+
+auto read_graph(Span<std::byte const> data) -> util::Result<GraphDescription> {
+    auto view = view_graph(data);
+    if (!view) {
+        return tl::make_unexpected(view.error());
+    }
+
+    GraphDescription description;
+
+    for (auto t = 0u; t < view->header.type_count; ++t) {
+        auto const type = view->type(t);
+        description.types.emplace_back(view->string(type.name_offset, type.name_size));
+    }
+
+    for (auto n = 0u; n < view->header.node_count; ++n) {
+        auto const node = view->node(n);
+        description.nodes.push_back({node.type,
+                                     view->string(node.name_offset, node.name_size),
+                                     {view->params + node.param_offset,
+                                      view->params + node.param_offset + node.param_size}});
+    }
+
+    for (auto e = 0u; e < view->header.edge_count; ++e) {
+        auto const edge = view->edge(e);
+        description.edges.push_back({{edge.from_node, edge.from_port}, {edge.to_node, edge.to_port}});
+    }
+
+    return description;
+}
+
+auto load_graph(Span<std::byte const> data, NodeTypeRegistry const& registry) -> util::Result<ddf> {
+    auto view = view_graph(data);
+    if (!view) {
+        return tl::make_unexpected(view.error());
+    }
+
+    // Resolve each type once so creating a node is an array lookup
+    std::vector<NodeTypeRegistry::NodeType const*> types(view->header.type_count);
+
+    for (auto t = 0u; t < types.size(); ++t) {
+        auto const record = view->type(t);
+        auto const name   = view->string(record.name_offset, record.name_size);
+
+        types[t] = registry.find(name);
+        if (!types[t]) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Unknown node type '" + name + "'"));
+        }
+    }
+
+    ddf graph;
+    graph.reserve(view->header.node_count);
+
+    for (auto n = 0u; n < view->header.node_count; ++n) {
+        auto const  record = view->node(n);
+        auto const& type   = *types[record.type];
+
+        if (type.param_size != NodeTypeRegistry::any_param_size && type.param_size != record.param_size) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Node " + std::to_string(n) + " has "
+                                                      + std::to_string(record.param_size) + " bytes of parameters but '"
+                                                      + type.name + "' expects " + std::to_string(type.param_size)));
+        }
+
+        auto const id = type.create(graph,
+                                    view->string(record.name_offset, record.name_size),
+                                    {view->params + record.param_offset, record.param_size});
+
+        if (id != n || graph.node_count() != n + 1u) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Node type '" + type.name + "' must add exactly one node"));
+        }
+    }
+
+    for (auto e = 0u; e < view->header.edge_count; ++e) {
+        auto const edge   = view->edge(e);
+        auto       result = graph.connect(PortRef{edge.from_node, edge.from_port}, PortRef{edge.to_node, edge.to_port});
+
+        if (!result) {
+            return tl::make_unexpected(result.error());
+        }
+    }
+
+    auto compiled = graph.compile();
+    if (!compiled) {
+        return tl::make_unexpected(compiled.error());
+    }
+
+    return graph;
+}
+
+auto load_graph_file(std::string const& path, NodeTypeRegistry const& registry) -> util::Result<ddf> {
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return tl::make_unexpected(file.error());
+    }
+    return load_graph(file->data(), registry);
+}
+
+auto MappedFile::open(std::string const& path) -> util::Result<MappedFile> {
+    MappedFile file;
+
+#ifdef LTB_DDF_HAS_MMAP
+    auto const descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Failed to open '" + path + "'"));
+    }
+
+    struct stat info = {};
+    if (::fstat(descriptor, &info) != 0) {
+        ::close(descriptor);
+        return tl::make_unexpected(LTB_MAKE_ERROR("Failed to read the size of '" + path + "'"));
+    }
+
+    file.size_ = static_cast<std::size_t>(info.st_size);
+
+    if (file.size_ > 0u) {
+        auto* memory = ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (memory == MAP_FAILED) {
+            ::close(descriptor);
+            return tl::make_unexpected(LTB_MAKE_ERROR("Failed to map '" + path + "'"));
+        }
+        file.data_   = static_cast<std::byte const*>(memory);
+        file.mapped_ = true;
+    }
+    ::close(descriptor);
+#else
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Failed to open '" + path + "'"));
+    }
+
+    file.buffer_.resize(static_cast<std::size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(file.buffer_.data()), static_cast<std::streamsize>(file.buffer_.size()));
+
+    file.data_ = file.buffer_.data();
+    file.size_ = file.buffer_.size();
+#endif
+
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+    if (this != &other) {
+        release();
+
+        data_   = std::exchange(other.data_, nullptr);
+        size_   = std::exchange(other.size_, 0u);
+        mapped_ = std::exchange(other.mapped_, false);
+        buffer_ = std::move(other.buffer_);
+    }
+    return *this;
+}
+
+auto MappedFile::data() const -> Span<std::byte const> {
+    return {data_, size_};
+}
+
+auto MappedFile::release() -> void {
+#ifdef LTB_DDF_HAS_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+#endif
+    data_   = nullptr;
+    size_   = 0u;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+namespace {
+
+struct Offset {
+    int amount;
+};
+
+auto make_test_registry() -> NodeTypeRegistry {
+    NodeTypeRegistry registry;
+
+    registry.add_type("one", Inputs<>{}, Outputs<int>{}, [] {
+        return [](NodeContext& ctx) { ctx.output<int>(0) = 1; };
+    });
+    registry.add_type<Offset>("offset", Inputs<int>{}, Outputs<int>{}, [](Offset const& offset) {
+        return [amount = offset.amount](NodeContext& ctx) { ctx.output<int>(0) = ctx.input<int>(0) + amount; };
+    });
+    return registry;
+}
+
+auto as_bytes(std::string const& str) -> Span<std::byte const> {
+    return {reinterpret_cast<std::byte const*>(str.data()), str.size()};
+}
+
+} // namespace
+
+TEST_CASE("[ltb][ddf] graphs round trip through the binary format") {
+    auto const registry = make_test_registry();
+
+    GraphDescription description;
+    auto const       source = description.add_node("one", "source");
+    auto const       plus_2 = description.add_node("offset", "plus 2", Offset{2});
+    auto const       plus_5 = description.add_node("offset", "plus 5", Offset{5});
+    description.connect({source, 0u}, {plus_2, 0u});
+    description.connect({plus_2, 0u}, {plus_5, 0u});
+
+    std::stringstream stream;
+    write_graph(stream, description);
+    auto const data = stream.str();
+
+    auto read = read_graph(as_bytes(data));
+    REQUIRE(read);
+    CHECK(read->types == description.types);
+    REQUIRE(read->nodes.size() == 3u);
+    CHECK(read->nodes[2].name == "plus 5");
+    CHECK(read->nodes[2].params == encode_params(Offset{5}));
+    REQUIRE(read->edges.size() == 2u);
+    CHECK(read->edges[1].to.node == plus_5);
+
+    auto graph = load_graph(as_bytes(data), registry);
+    REQUIRE(graph);
+    CHECK(graph->is_compiled());
+
+    graph->tick();
+    CHECK(graph->value(OutputPort<int>{plus_5, 0u}) == 8);
+    CHECK(graph->node_name(plus_2) == "plus 2");
+
+    SUBCASE("from a memory-mapped file") {
+        auto const path = std::string("ltb_ddf_graph_file_test.ddfg");
+        {
+            std::ofstream file(path, std::ios::binary);
+            write_graph(file, description);
+        }
+
+        auto loaded = load_graph_file(path, registry);
+        std::remove(path.c_str());
+
+        REQUIRE(loaded);
+        loaded->tick();
+        CHECK(loaded->value(OutputPort<int>{plus_5, 0u}) == 8);
+
+        CHECK_FALSE(load_graph_file(path, registry));
+    }
+}
+
+TEST_CASE("[ltb][ddf] invalid graph data is rejected") {
+    auto const registry = make_test_registry();
+
+    GraphDescription description;
+    auto const       source = description.add_node("one", "source");
+    auto const       offset = description.add_node("offset", "offset", Offset{1});
+
+    SUBCASE("unknown type") {
+        description.add_node("missing", "missing");
+    }
+    SUBCASE("wrong parameter size") {
+        description.add_node("offset", "bad params", std::vector<std::byte>(1u));
+    }
+    SUBCASE("invalid edge") {
+        description.connect({source, 0u}, {offset, 3u});
+    }
+    SUBCASE("unconnected input") {}
+
+    std::stringstream stream;
+    write_graph(stream, description);
+    auto const data = stream.str();
+
+    CHECK_FALSE(load_graph(as_bytes(data), registry));
+    CHECK_FALSE(load_graph(as_bytes(data.substr(0u, data.size() - 1u)), registry));
+    CHECK_FALSE(load_graph(as_bytes("not a graph at all, just text"), registry));
+}
+
+} // namespace ltb::ddf
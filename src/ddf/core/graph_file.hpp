@@ -0,0 +1,112 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf.hpp"
+#include "events.hpp"
+#include "node_registry.hpp"
+#include "ltb/util/result.hpp"
+
+// standard
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief A serializable description of a graph: typed nodes with parameters and the edges between them
+struct GraphDescription {
+    struct NodeDescription {
+        std::uint32_t          type; ///< Index into 'types'
+        std::string            name;
+        std::vector<std::byte> params;
+    };
+
+    struct EdgeDescription {
+        PortRef from; ///< An output port
+        PortRef to; ///< An input port
+    };
+
+    std::vector<std::string>     types; ///< Node type ids as registered in a NodeTypeRegistry
+    std::vector<NodeDescription> nodes; ///< Indexed by the NodeId the node gets when loaded
+    std::vector<EdgeDescription> edges;
+
+    /// \brief Adds a node of registered type 'type' and returns the id it will have once loaded
+    auto add_node(std::string const& type, std::string name, std::vector<std::byte> params = {}) -> NodeId;
+
+    template <typename Params>
+    auto add_node(std::string const& type, std::string name, Params const& params) -> NodeId {
+        return add_node(type, std::move(name), encode_params(params));
+    }
+
+    auto connect(PortRef const& from, PortRef const& to) -> void;
+};
+
+/**
+ * @brief Writes 'description' in the binary graph format.
+ *
+ * The format is a fixed header followed by flat arrays of fixed-size records (types, nodes
+ * and edges, all 32-bit fields in native byte order) and finally the string and parameter
+ * bytes they refer to, so a loader can use a memory-mapped file directly.
+ */
+auto write_graph(std::ostream& out, GraphDescription const& description) -> void;
+
+/// \brief Reads a binary graph back into a description
+auto read_graph(Span<std::byte const> data) -> util::Result<GraphDescription>;
+
+/// \brief Instantiates every node of a binary graph with 'registry', connects the edges and
+///        compiles the result. Node ids match the node indices in the file.
+auto load_graph(Span<std::byte const> data, NodeTypeRegistry const& registry) -> util::Result<ddf>;
+
+/// \brief Memory-maps 'path' and loads the graph it contains
+auto load_graph_file(std::string const& path, NodeTypeRegistry const& registry) -> util::Result<ddf>;
+
+/// \brief A read-only view of a whole file. Memory-mapped where supported, otherwise read into memory.
+class MappedFile {
+public:
+    static auto open(std::string const& path) -> util::Result<MappedFile>;
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    auto operator=(MappedFile const&) -> MappedFile& = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+    auto data() const -> Span<std::byte const>;
+
+private:
+    auto release() -> void;
+
+    std::byte const*       data_   = nullptr;
+    std::size_t            size_   = 0u;
+    bool                   mapped_ = false; ///< True if 'data_' must be unmapped
+    std::vector<std::byte> buffer_; ///< The file contents when mapping is not available
+};
+
+} // namespace ltb::ddf
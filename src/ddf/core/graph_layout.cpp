@@ -0,0 +1,416 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "graph_layout.hpp"
+
+// project
+#include "ddf.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <numeric>
+
+namespace ltb::ddf {
+namespace {
+
+using Vertex = std::uint32_t;
+
+/// \brief The graph split into layers, with dummy vertices (ids past the real nodes) on long connections
+struct LayeredGraph {
+    std::size_t                      node_count = 0u; ///< Vertices below this are real nodes
+    std::vector<std::vector<Vertex>> layers; ///< Vertices of each layer in their current order
+    std::vector<std::uint32_t>       layer_of; ///< Indexed by Vertex
+    std::vector<std::uint32_t>       order; ///< Indexed by Vertex, position within its layer
+    std::vector<std::vector<Vertex>> previous; ///< Indexed by Vertex, neighbours in the layer before
+    std::vector<std::vector<Vertex>> next; ///< Indexed by Vertex, neighbours in the layer after
+
+    auto add_vertex(std::uint32_t layer) -> Vertex {
+        auto const vertex = static_cast<Vertex>(layer_of.size());
+        layer_of.emplace_back(layer);
+        order.emplace_back(static_cast<std::uint32_t>(layers[layer].size()));
+        previous.emplace_back();
+        next.emplace_back();
+        layers[layer].emplace_back(vertex);
+        return vertex;
+    }
+
+    auto connect(Vertex from, Vertex to) -> void {
+        next[from].emplace_back(to);
+        previous[to].emplace_back(from);
+    }
+};
+
+auto build_layers(GraphTopology const& topology) -> LayeredGraph {
+    auto const node_count = topology.node_names.size();
+
+    auto successors  = std::vector<std::vector<NodeId>>(node_count);
+    auto input_edges = std::vector<std::size_t>(node_count, 0u);
+    for (auto const& edge : topology.edges) {
+        successors[edge.from.node].emplace_back(edge.to.node);
+        ++input_edges[edge.to.node];
+    }
+
+    // Longest path layering in breadth first order, which is also the initial order in each layer
+    auto depth   = std::vector<std::uint32_t>(node_count, 0u);
+    auto visited = std::vector<NodeId>{};
+    visited.reserve(node_count);
+    for (auto n = 0u; n < node_count; ++n) {
+        if (input_edges[n] == 0u) {
+            visited.emplace_back(static_cast<NodeId>(n));
+        }
+    }
+    for (auto i = 0u; i < visited.size(); ++i) {
+        auto const node = visited[i];
+        for (auto const successor : successors[node]) {
+            depth[successor] = std::max(depth[successor], depth[node] + 1u);
+            if (--input_edges[successor] == 0u) {
+                visited.emplace_back(successor);
+            }
+        }
+    }
+    // Nodes in a cycle are never visited and keep the depth their other inputs gave them
+    for (auto n = 0u; n < node_count; ++n) {
+        if (input_edges[n] != 0u) {
+            visited.emplace_back(static_cast<NodeId>(n));
+        }
+    }
+
+    auto graph       = LayeredGraph{};
+    graph.node_count = node_count;
+    graph.layers.resize(node_count == 0u ? 0u : *std::max_element(depth.begin(), depth.end()) + 1u);
+    graph.layer_of.resize(node_count);
+    graph.order.resize(node_count);
+    graph.previous.resize(node_count);
+    graph.next.resize(node_count);
+
+    for (auto const node : visited) {
+        graph.layer_of[node] = depth[node];
+        graph.order[node]    = static_cast<std::uint32_t>(graph.layers[depth[node]].size());
+        graph.layers[depth[node]].emplace_back(node);
+    }
+
+    for (auto const node : visited) {
+        for (auto const successor : successors[node]) {
+            if (depth[successor] <= depth[node]) {
+                continue;
+            }
+            auto from = static_cast<Vertex>(node);
+            for (auto layer = depth[node] + 1u; layer < depth[successor]; ++layer) {
+                auto const dummy = graph.add_vertex(layer);
+                graph.connect(from, dummy);
+                from = dummy;
+            }
+            graph.connect(from, successor);
+        }
+    }
+    return graph;
+}
+
+/// \brief Calls 'function(i)' for every i in [0, count) from up to 'threads' threads
+template <typename Function>
+auto parallel_for(std::size_t count, unsigned threads, Function const& function) -> void {
+    auto next_index = std::atomic_size_t{0u};
+    auto work       = [&] {
+        for (auto i = next_index++; i < count; i = next_index++) {
+            function(i);
+        }
+    };
+
+    auto workers = std::vector<std::thread>{};
+    for (auto t = 1u; t < std::min<std::size_t>(threads, count); ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/// \brief Crossings between 'layer' and the one after it (Barth, Juenger and Mutzel's inversion count)
+auto count_crossings(LayeredGraph const& graph, std::size_t layer) -> std::size_t {
+    // Segments sorted by their end in 'layer' then their end in the next layer. Every pair
+    // whose order in the next layer is inverted is a crossing.
+    auto ends = std::vector<std::uint32_t>{};
+    for (auto const vertex : graph.layers[layer]) {
+        auto const first = ends.size();
+        for (auto const successor : graph.next[vertex]) {
+            ends.emplace_back(graph.order[successor]);
+        }
+        std::sort(ends.begin() + static_cast<std::ptrdiff_t>(first), ends.end());
+    }
+
+    // Fenwick tree of how many ends were seen at each order
+    auto tree      = std::vector<std::size_t>(graph.layers[layer + 1u].size() + 1u, 0u);
+    auto crossings = std::size_t{0u};
+    for (auto i = 0u; i < ends.size(); ++i) {
+        auto not_after = std::size_t{0u};
+        for (auto j = ends[i] + 1u; j > 0u; j -= j & (~j + 1u)) {
+            not_after += tree[j];
+        }
+        crossings += i - not_after;
+        for (auto j = ends[i] + 1u; j < tree.size(); j += j & (~j + 1u)) {
+            ++tree[j];
+        }
+    }
+    return crossings;
+}
+
+auto count_crossings(LayeredGraph const& graph, unsigned threads) -> std::size_t {
+    if (graph.layers.size() < 2u) {
+        return 0u;
+    }
+    auto per_layer = std::vector<std::size_t>(graph.layers.size() - 1u);
+    parallel_for(per_layer.size(), threads, [&](std::size_t layer) {
+        per_layer[layer] = count_crossings(graph, layer);
+    });
+    return std::accumulate(per_layer.begin(), per_layer.end(), std::size_t{0u});
+}
+
+/// \brief Sorts 'layer' by the mean order of each vertex's neighbours in both adjacent layers
+auto sort_by_barycenter(LayeredGraph* graph, std::size_t layer) -> void {
+    auto& vertices = graph->layers[layer];
+
+    auto keys = std::vector<std::pair<double, Vertex>>{};
+    keys.reserve(vertices.size());
+    for (auto const vertex : vertices) {
+        auto sum   = 0.0;
+        auto count = graph->previous[vertex].size() + graph->next[vertex].size();
+        for (auto const neighbour : graph->previous[vertex]) {
+            sum += graph->order[neighbour];
+        }
+        for (auto const neighbour : graph->next[vertex]) {
+            sum += graph->order[neighbour];
+        }
+        // Unconnected vertices hold their place
+        keys.emplace_back(count == 0u ? graph->order[vertex] : sum / static_cast<double>(count), vertex);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+
+    for (auto i = 0u; i < keys.size(); ++i) {
+        vertices[i]                  = keys[i].second;
+        graph->order[keys[i].second] = i;
+    }
+}
+
+auto place_nodes(LayeredGraph const& graph, LayoutOptions const& options, std::vector<NodePosition>* positions)
+    -> void {
+    positions->resize(graph.node_count);
+
+    // Dummy vertices only route connections, which the editor draws itself, so they take no room
+    for (auto layer = 0u; layer < graph.layers.size(); ++layer) {
+        auto const& vertices = graph.layers[layer];
+        auto const  rows     = std::count_if(vertices.begin(), vertices.end(), [&graph](Vertex vertex) {
+            return vertex < graph.node_count;
+        });
+
+        auto row = 0.f;
+        for (auto const vertex : vertices) {
+            if (vertex < graph.node_count) {
+                (*positions)[vertex] = {options.layer_spacing * static_cast<float>(layer),
+                                        options.row_spacing * (row - 0.5f * static_cast<float>(rows - 1))};
+                row += 1.f;
+            }
+        }
+    }
+}
+
+} // namespace
+
+auto layered_layout(GraphTopology const&                               topology,
+                    LayoutOptions const&                               options,
+                    std::function<bool(LayoutSnapshot const&)> const& progress) -> LayoutSnapshot {
+    auto const threads = options.threads == 0u ? std::max(1u, std::thread::hardware_concurrency()) : options.threads;
+
+    auto graph    = build_layers(topology);
+    auto snapshot = LayoutSnapshot{};
+
+    auto report = [&](std::size_t crossings, bool finished) {
+        ++snapshot.sequence;
+        snapshot.crossings = crossings;
+        snapshot.finished  = finished;
+        place_nodes(graph, options, &snapshot.positions);
+        return !progress || progress(snapshot);
+    };
+
+    auto best_crossings = count_crossings(graph, threads);
+    if (!report(best_crossings, false)) {
+        return snapshot;
+    }
+
+    // Sweeps can make things worse before they get better, so keep the best ordering seen
+    auto best_layers = graph.layers;
+    auto stale       = 0u;
+    for (auto iteration = 0u; iteration < options.iterations && best_crossings > 0u && stale < 4u; ++iteration) {
+        for (auto const parity : {iteration % 2u, (iteration + 1u) % 2u}) {
+            parallel_for((graph.layers.size() + 1u - parity) / 2u, threads, [&](std::size_t i) {
+                sort_by_barycenter(&graph, 2u * i + parity);
+            });
+        }
+
+        auto const crossings = count_crossings(graph, threads);
+        if (crossings >= best_crossings) {
+            ++stale;
+            continue;
+        }
+        stale          = 0u;
+        best_crossings = crossings;
+        best_layers    = graph.layers;
+        if (!report(best_crossings, false)) {
+            return snapshot;
+        }
+    }
+
+    graph.layers = std::move(best_layers);
+    for (auto const& layer : graph.layers) {
+        for (auto i = 0u; i < layer.size(); ++i) {
+            graph.order[layer[i]] = i;
+        }
+    }
+    report(best_crossings, true);
+    return snapshot;
+}
+
+LayoutJob::LayoutJob(GraphTopology topology, LayoutOptions options)
+    : thread_([this, topology = std::move(topology), options] {
+          layered_layout(topology, options, [this](LayoutSnapshot const& snapshot) {
+              snapshots_.write(snapshot);
+              return !cancelled_.load(std::memory_order_relaxed);
+          });
+      }) {}
+
+LayoutJob::~LayoutJob() {
+    cancelled_.store(true, std::memory_order_relaxed);
+    thread_.join();
+}
+
+auto LayoutJob::update() -> bool {
+    return snapshots_.update();
+}
+
+auto LayoutJob::latest() const -> LayoutSnapshot const& {
+    return snapshots_.read();
+}
+
+namespace {
+
+auto make_topology(std::size_t node_count, std::vector<std::pair<NodeId, NodeId>> const& connections)
+    -> GraphTopology {
+    auto topology = GraphTopology{};
+    topology.node_names.resize(node_count);
+    topology.input_counts.assign(node_count, 1u);
+    topology.output_counts.assign(node_count, 1u);
+    for (auto const& [from, to] : connections) {
+        topology.edges.push_back({PortRef{from, 0u}, PortRef{to, 0u}});
+    }
+    return topology;
+}
+
+} // namespace
+
+TEST_CASE("[ltb][ddf] layered layout puts each node after its inputs") {
+    // 0 -> 1 -> 2 and 0 -> 2
+    auto const layout = layered_layout(make_topology(3u, {{0u, 1u}, {1u, 2u}, {0u, 2u}}));
+
+    CHECK(layout.finished);
+    CHECK(layout.crossings == 0u);
+    REQUIRE(layout.positions.size() == 3u);
+    CHECK(layout.positions[0].x < layout.positions[1].x);
+    CHECK(layout.positions[1].x < layout.positions[2].x);
+}
+
+TEST_CASE("[ltb][ddf] layered layout removes crossings") {
+    // Breadth first order gives [0, 1, 2] and [3, 4], so 0 -> 4 crosses 1 -> 3 and 2 -> 3
+    auto progress = std::vector<LayoutSnapshot>{};
+    auto const layout = layered_layout(make_topology(5u, {{0u, 4u}, {1u, 3u}, {2u, 3u}, {2u, 4u}}),
+                                       {},
+                                       [&progress](LayoutSnapshot const& snapshot) {
+                                           progress.emplace_back(snapshot);
+                                           return true;
+                                       });
+
+    REQUIRE(progress.size() >= 2u);
+    CHECK(progress.front().crossings == 2u);
+    CHECK_FALSE(progress.front().finished);
+    CHECK(progress.back().finished);
+    CHECK(progress.back().sequence == progress.size());
+    CHECK(layout.crossings == 0u);
+    CHECK(layout.positions[3].y < layout.positions[4].y);
+    CHECK(layout.positions[1].y < layout.positions[2].y);
+    CHECK(layout.positions[2].y < layout.positions[0].y);
+}
+
+TEST_CASE("[ltb][ddf] layered layout does not depend on the thread count") {
+    // Layers of ten nodes, each connected to a scattered few in the next layer and the one after
+    auto connections = std::vector<std::pair<NodeId, NodeId>>{};
+    for (auto layer = 0u; layer < 19u; ++layer) {
+        for (auto i = 0u; i < 10u; ++i) {
+            auto const from = static_cast<NodeId>(layer * 10u + i);
+            connections.emplace_back(from, static_cast<NodeId>((layer + 1u) * 10u + (i * 7u + 3u) % 10u));
+            if (layer + 2u < 20u) {
+                connections.emplace_back(from, static_cast<NodeId>((layer + 2u) * 10u + (i * 3u + 1u) % 10u));
+            }
+        }
+    }
+    auto const topology = make_topology(200u, connections);
+
+    auto single    = LayoutOptions{};
+    single.threads = 1u;
+    auto multi     = LayoutOptions{};
+    multi.threads  = 4u;
+
+    auto const first  = layered_layout(topology, single);
+    auto const second = layered_layout(topology, multi);
+
+    auto initial = std::size_t{0u};
+    layered_layout(topology, single, [&initial](LayoutSnapshot const& snapshot) {
+        initial = snapshot.crossings;
+        return false;
+    });
+
+    CHECK(first.crossings < initial);
+    CHECK(first.crossings == second.crossings);
+    for (auto n = 0u; n < 200u; ++n) {
+        CHECK(first.positions[n].x == second.positions[n].x);
+        CHECK(first.positions[n].y == second.positions[n].y);
+    }
+}
+
+TEST_CASE("[ltb][ddf] layout job streams snapshots") {
+    auto job = LayoutJob(make_topology(5u, {{0u, 4u}, {1u, 3u}, {2u, 3u}, {2u, 4u}}));
+
+    auto seen = std::size_t{0u};
+    while (!job.latest().finished) {
+        if (job.update()) {
+            ++seen;
+        }
+        std::this_thread::yield();
+    }
+
+    CHECK(seen >= 1u);
+    CHECK(job.latest().crossings == 0u);
+    CHECK(job.latest().positions.size() == 5u);
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,105 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "graph_metrics.hpp"
+#include "triple_buffer.hpp"
+
+// standard
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace ltb::ddf {
+
+struct LayoutOptions {
+    float    layer_spacing = 220.f; ///< Horizontal distance between layers
+    float    row_spacing   = 120.f; ///< Vertical distance between nodes in a layer
+    unsigned iterations    = 24u; ///< Upper bound on crossing minimization sweeps
+    unsigned threads       = 0u; ///< Crossing minimization threads, 0 for one per hardware thread
+};
+
+struct NodePosition {
+    float x = 0.f;
+    float y = 0.f;
+};
+
+struct LayoutSnapshot {
+    std::uint64_t             sequence  = 0u; ///< Incremented for every snapshot, 0 if none was taken yet
+    std::size_t               crossings = 0u; ///< Edge crossings in this layout, counting dummy segments
+    bool                      finished  = false; ///< No better layout will follow
+    std::vector<NodePosition> positions; ///< Indexed by NodeId
+};
+
+/**
+ * @brief Lays a graph out left to right in layers (Sugiyama style).
+ *
+ * 1. Each node goes in the layer one past its deepest input. Connections spanning several
+ *    layers are split by invisible dummy nodes so every segment joins adjacent layers.
+ * 2. Edge crossings are reduced by repeatedly sorting each layer by the mean order of its
+ *    neighbours in the two adjacent layers. Even and odd layers take turns, so every layer
+ *    of a turn only reads layers that are not changing and all of them are sorted in
+ *    parallel. The result is the same for any number of threads.
+ * 3. Each node is placed at its layer's column and its order within the layer.
+ *
+ * 'progress' is called with the first layout, again whenever crossings are reduced and once
+ * more with 'finished' set. It returns false to stop early. Connections that would point
+ * backwards (in a cycle) are ignored when ordering.
+ */
+auto layered_layout(GraphTopology const&                               topology,
+                    LayoutOptions const&                               options  = {},
+                    std::function<bool(LayoutSnapshot const&)> const& progress = nullptr) -> LayoutSnapshot;
+
+/**
+ * @brief Runs 'layered_layout' on a background thread and streams its progress.
+ *
+ * Every snapshot is published through a TripleBuffer, so a UI thread can call 'update' and
+ * read 'latest' each frame to show the layout improving without ever waiting on it.
+ * Destroying the job stops the layout at the next sweep.
+ */
+class LayoutJob {
+public:
+    explicit LayoutJob(GraphTopology topology, LayoutOptions options = {});
+    ~LayoutJob();
+
+    LayoutJob(LayoutJob const&) = delete;
+    LayoutJob(LayoutJob&&)      = delete;
+    auto operator=(LayoutJob const&) -> LayoutJob& = delete;
+    auto operator=(LayoutJob&&) -> LayoutJob& = delete;
+
+    /// \brief Reader only. Fetches the newest snapshot. Returns true if it changed.
+    auto update() -> bool;
+
+    /// \brief Reader only. The snapshot fetched by the last 'update'.
+    auto latest() const -> LayoutSnapshot const&;
+
+private:
+    TripleBuffer<LayoutSnapshot> snapshots_;
+    std::atomic_bool             cancelled_{false};
+    std::thread                  thread_; ///< Last so it starts after everything above
+};
+
+} // namespace ltb::ddf
@@ -0,0 +1,247 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "graph_metrics.hpp"
+
+// project
+#include "channels.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <thread>
+
+namespace ltb::ddf {
+namespace {
+
+/// \brief The count and total recorded since 'previous', which is then moved forward
+auto window(Histogram const& histogram, std::uint64_t* previous_count, std::uint64_t* previous_total)
+    -> std::pair<std::uint64_t, std::uint64_t> {
+    // The profiler may have been reset since the last sample
+    if (histogram.count() < *previous_count) {
+        *previous_count = 0u;
+        *previous_total = 0u;
+    }
+
+    auto const result = std::make_pair(histogram.count() - *previous_count, histogram.total() - *previous_total);
+    *previous_count   = histogram.count();
+    *previous_total   = histogram.total();
+    return result;
+}
+
+auto ratio(std::uint64_t numerator, std::uint64_t denominator) -> double {
+    return denominator == 0u ? 0.0 : static_cast<double>(numerator) / static_cast<double>(denominator);
+}
+
+} // namespace
+
+auto capture_topology(ddf const& graph) -> GraphTopology {
+    auto topology = GraphTopology{};
+
+    for (auto n = 0u; n < graph.node_count(); ++n) {
+        auto const& node = graph.nodes()[n];
+
+        topology.node_names.emplace_back(node.name);
+        topology.input_counts.emplace_back(node.input_types.size());
+        topology.output_counts.emplace_back(node.output_types.size());
+
+        for (auto i = 0u; i < node.input_sources.size(); ++i) {
+            if (node.input_sources[i].node != invalid_node) {
+                topology.edges.push_back({node.input_sources[i], PortRef{static_cast<NodeId>(n), i}});
+            }
+        }
+    }
+    return topology;
+}
+
+MetricsSampler::MetricsSampler(std::chrono::nanoseconds interval) : interval_(interval) {}
+
+auto MetricsSampler::sample(ddf const& graph) -> bool {
+    auto const now = Profiler::now();
+
+    if (sequence_ != 0u && now - last_sample_ns_ < static_cast<std::uint64_t>(interval_.count())) {
+        return false;
+    }
+
+    auto const  elapsed_ns = sequence_ == 0u ? 0u : now - last_sample_ns_;
+    auto const* profiler   = graph.profiler();
+    auto&       snapshot   = snapshots_.write_buffer();
+
+    snapshot.sequence     = ++sequence_;
+    snapshot.timestamp_ns = now;
+    last_sample_ns_       = now;
+
+    if (!profiler) {
+        snapshot.ticks_per_second = 0.0;
+        snapshot.mean_tick_ns     = 0.0;
+        snapshot.nodes.assign(graph.node_count(), NodeMetrics{});
+        snapshot.channels.clear();
+        snapshots_.publish();
+        return true;
+    }
+
+    auto const per_second = [elapsed_ns](std::uint64_t count) { return ratio(count * 1'000'000'000u, elapsed_ns); };
+
+    auto const ticks = window(profiler->ticks().duration_ns, &previous_ticks_.count, &previous_ticks_.total);
+    snapshot.ticks_per_second = per_second(ticks.first);
+    snapshot.mean_tick_ns     = ratio(ticks.second, ticks.first);
+
+    auto const& nodes = profiler->nodes();
+    previous_nodes_.resize(nodes.size());
+    snapshot.nodes.resize(nodes.size());
+
+    auto total_node_ns = std::uint64_t{0u};
+    for (auto n = 0u; n < nodes.size(); ++n) {
+        auto const runs = window(nodes[n].execution_ns, &previous_nodes_[n].count, &previous_nodes_[n].total);
+
+        snapshot.nodes[n].mean_ns         = ratio(runs.second, runs.first);
+        snapshot.nodes[n].runs_per_second = per_second(runs.first);
+        snapshot.nodes[n].share_of_tick   = static_cast<double>(runs.second);
+        total_node_ns += runs.second;
+    }
+    for (auto& node : snapshot.nodes) {
+        node.share_of_tick = total_node_ns == 0u ? 0.0 : node.share_of_tick / static_cast<double>(total_node_ns);
+    }
+
+    auto const& edges = profiler->edges();
+    previous_channels_.resize(edges.size());
+    snapshot.channels.resize(edges.size());
+
+    for (auto e = 0u; e < edges.size(); ++e) {
+        auto const depth = window(edges[e].queue_depth, &previous_channels_[e].count, &previous_channels_[e].total);
+
+        snapshot.channels[e].name             = edges[e].name;
+        snapshot.channels[e].mean_queue_depth = ratio(depth.second, depth.first);
+        snapshot.channels[e].max_queue_depth  = edges[e].queue_depth.max();
+        snapshot.channels[e].dropped          = edges[e].dropped;
+    }
+
+    snapshots_.publish();
+    return true;
+}
+
+auto MetricsSampler::update() -> bool {
+    return snapshots_.update();
+}
+
+auto MetricsSampler::latest() const -> GraphMetrics const& {
+    return snapshots_.read();
+}
+
+TEST_CASE("[ltb][ddf] graph topology") {
+    ddf graph;
+
+    auto source = graph.add_source("source", [] { return 1; });
+    auto sum    = graph.add_transform("sum", [](int x, int y) { return x + y; }, source, source);
+    graph.add_sink("sink", [](int) {}, sum);
+
+    auto const topology = capture_topology(graph);
+    CHECK(topology.node_names == std::vector<std::string>{"source", "sum", "sink"});
+    CHECK(topology.input_counts == std::vector<std::size_t>{0u, 2u, 1u});
+    CHECK(topology.output_counts == std::vector<std::size_t>{1u, 1u, 0u});
+    REQUIRE(topology.edges.size() == 3u);
+    CHECK(topology.edges[1].from.node == 0u);
+    CHECK(topology.edges[1].to.node == 1u);
+    CHECK(topology.edges[1].to.index == 1u);
+    CHECK(topology.edges[2].to.node == 2u);
+}
+
+TEST_CASE("[ltb][ddf] metrics sampler publishes snapshots") {
+    ddf graph;
+
+    auto source = graph.add_source("source", [] { return 1; });
+    auto slow   = graph.add_transform(
+        "slow",
+        [](int x) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            return x;
+        },
+        source);
+    graph.add_sink("sink", [](int) {}, slow);
+
+    graph.enable_profiling();
+    REQUIRE(graph.compile());
+
+    MetricsSampler sampler(std::chrono::milliseconds(0));
+    CHECK_FALSE(sampler.update());
+    CHECK(sampler.latest().sequence == 0u);
+
+    for (auto i = 0; i < 5; ++i) {
+        graph.tick();
+    }
+    REQUIRE(sampler.sample(graph));
+    REQUIRE(sampler.update());
+
+    auto const& metrics = sampler.latest();
+    CHECK(metrics.sequence == 1u);
+    REQUIRE(metrics.nodes.size() == 3u);
+
+    if (!profiling_enabled) {
+        CHECK(metrics.nodes[1].mean_ns == 0.0);
+        return;
+    }
+
+    // The first sample has no window to measure rates over, but times are averaged
+    CHECK(metrics.nodes[1].mean_ns >= 200'000.0);
+    CHECK(metrics.nodes[1].share_of_tick > metrics.nodes[0].share_of_tick);
+    CHECK(metrics.mean_tick_ns >= metrics.nodes[1].mean_ns);
+
+    // Only the ticks since the previous sample are counted
+    graph.tick();
+    REQUIRE(sampler.sample(graph));
+    REQUIRE(sampler.update());
+    CHECK(sampler.latest().sequence == 2u);
+    CHECK(sampler.latest().nodes[1].runs_per_second > 0.0);
+    CHECK(sampler.latest().ticks_per_second > 0.0);
+}
+
+TEST_CASE("[ltb][ddf] metrics sampler across threads") {
+    ddf graph;
+    graph.add_source("source", [] { return 1; });
+    graph.enable_profiling();
+    REQUIRE(graph.compile());
+
+    MetricsSampler sampler(std::chrono::milliseconds(0));
+
+    std::thread ticker([&] {
+        for (auto i = 0; i < 1000; ++i) {
+            graph.tick();
+            sampler.sample(graph);
+        }
+    });
+
+    // Sequence numbers never go backwards and every snapshot is complete
+    auto consistent = true;
+    auto last       = std::uint64_t{0u};
+    while (last < 1000u) {
+        if (sampler.update()) {
+            consistent &= sampler.latest().sequence > last && sampler.latest().nodes.size() == 1u;
+            last = sampler.latest().sequence;
+        }
+    }
+    ticker.join();
+
+    CHECK(consistent);
+}
+
+} // namespace ltb::ddf
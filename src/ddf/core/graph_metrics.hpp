@@ -0,0 +1,120 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf.hpp"
+#include "triple_buffer.hpp"
+
+// standard
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief The shape of a graph: enough to draw it without touching the graph again
+struct GraphTopology {
+    struct Edge {
+        PortRef from;
+        PortRef to;
+    };
+
+    std::vector<std::string> node_names; ///< Indexed by NodeId
+    std::vector<std::size_t> input_counts; ///< Indexed by NodeId
+    std::vector<std::size_t> output_counts; ///< Indexed by NodeId
+    std::vector<Edge>        edges;
+};
+
+/// \brief Captures the nodes and connections of 'graph'
+auto capture_topology(ddf const& graph) -> GraphTopology;
+
+/// \brief Node statistics over the window since the previous snapshot
+struct NodeMetrics {
+    double mean_ns          = 0.0; ///< Mean execution time
+    double runs_per_second  = 0.0;
+    double share_of_tick    = 0.0; ///< Fraction of the window's total node time spent in this node
+};
+
+/// \brief Statistics for a cross-region channel over the window since the previous snapshot
+struct ChannelMetrics {
+    std::string   name;
+    double        mean_queue_depth = 0.0;
+    std::uint64_t max_queue_depth  = 0u; ///< Since profiling started
+    std::uint64_t dropped          = 0u; ///< Since profiling started
+};
+
+struct GraphMetrics {
+    std::uint64_t               sequence     = 0u; ///< Incremented for every snapshot, 0 if none was taken yet
+    std::uint64_t               timestamp_ns = 0u; ///< See 'Profiler::now'
+    double                      ticks_per_second = 0.0;
+    double                      mean_tick_ns     = 0.0;
+    std::vector<NodeMetrics>    nodes; ///< Indexed by NodeId
+    std::vector<ChannelMetrics> channels;
+};
+
+/**
+ * @brief Publishes live metrics of a running graph to another thread without locking.
+ *
+ * 'sample' is called by whichever thread ticks the graph, between ticks (for example from
+ * 'RegionOptions::after_tick'). At most once per interval it turns the graph's profiler
+ * counters into a GraphMetrics snapshot, reusing the snapshot's storage, and publishes it
+ * through a TripleBuffer. A viewer calls 'update' and reads 'latest' each frame, so
+ * neither side ever waits on the other.
+ *
+ * The graph must have profiling enabled (see 'ddf::enable_profiling'). Without it every
+ * snapshot is empty.
+ */
+class MetricsSampler {
+public:
+    explicit MetricsSampler(std::chrono::nanoseconds interval = std::chrono::milliseconds(100));
+
+    /// \brief Tick thread only. Publishes a snapshot if 'interval' has passed since the last one.
+    ///        Returns true if one was published.
+    auto sample(ddf const& graph) -> bool;
+
+    /// \brief Reader only. Fetches the newest snapshot. Returns true if it changed.
+    auto update() -> bool;
+
+    /// \brief Reader only. The snapshot fetched by the last 'update'.
+    auto latest() const -> GraphMetrics const&;
+
+private:
+    struct Counter {
+        std::uint64_t count = 0u;
+        std::uint64_t total = 0u;
+    };
+
+    std::chrono::nanoseconds   interval_;
+    TripleBuffer<GraphMetrics> snapshots_;
+
+    // Sampling thread state
+    std::uint64_t        sequence_       = 0u;
+    std::uint64_t        last_sample_ns_ = 0u;
+    Counter              previous_ticks_;
+    std::vector<Counter> previous_nodes_;
+    std::vector<Counter> previous_channels_;
+};
+
+} // namespace ltb::ddf
@@ -0,0 +1,150 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "memo_cache.hpp"
+
+// project
+#include "ddf.hpp"
+#include "parallel_executor.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <string>
+#include <vector>
+
+TEST_CASE("[ltb][ddf] memo cache evicts the least recently used entry") {
+    using namespace ltb;
+
+    auto calls  = 0;
+    auto square = [&calls](int x) { return ++calls, x * x; };
+
+    ddf::MemoCache<int(int)> cache(2u);
+    CHECK_THROWS(ddf::MemoCache<int(int)>(0u));
+
+    CHECK(cache.get_or_compute(square, 2) == 4);
+    CHECK(cache.get_or_compute(square, 3) == 9);
+    CHECK(cache.get_or_compute(square, 2) == 4);
+    CHECK(calls == 2);
+    CHECK(cache.hits() == 1u);
+    CHECK(cache.misses() == 2u);
+
+    // 3 is the least recently used entry
+    CHECK(cache.get_or_compute(square, 4) == 16);
+    CHECK(cache.evictions() == 1u);
+    CHECK(cache.size() == 2u);
+    CHECK_FALSE(cache.find(3));
+    REQUIRE(cache.find(2));
+    CHECK(*cache.find(2) == 4);
+    CHECK(calls == 3);
+
+    cache.clear();
+    CHECK(cache.size() == 0u);
+    CHECK_FALSE(cache.find(2));
+}
+
+TEST_CASE("[ltb][ddf] memo cache keys on every argument") {
+    using namespace ltb;
+
+    auto calls  = 0;
+    auto concat = [&calls](std::string const& text, int count) {
+        ++calls;
+        auto result = std::string();
+        for (auto i = 0; i < count; ++i) {
+            result += text;
+        }
+        return result;
+    };
+
+    ddf::MemoCache<std::string(std::string, int)> cache(8u);
+
+    CHECK(cache.get_or_compute(concat, "ab", 2) == "abab");
+    CHECK(cache.get_or_compute(concat, "ab", 3) == "ababab");
+    CHECK(cache.get_or_compute(concat, "ba", 2) == "baba");
+    CHECK(cache.get_or_compute(concat, "ab", 2) == "abab");
+    CHECK(calls == 3);
+    CHECK(ddf::MemoCache<std::string(std::string, int)>::hash("ab", 2)
+          != ddf::MemoCache<std::string(std::string, int)>::hash("ab", 3));
+}
+
+TEST_CASE("[ltb][ddf] memoized transforms skip repeated inputs") {
+    using namespace ltb;
+
+    ddf::ddf graph;
+
+    auto inputs = std::vector<int>{1, 2, 1, 2, 3, 1};
+    auto tick   = 0u;
+    auto calls  = 0;
+
+    auto cache  = std::make_shared<ddf::MemoCache<int(int, int)>>(2u);
+    auto source = graph.add_source("source", [&] { return inputs[tick++]; });
+    auto offset = graph.add_source("offset", [] { return 100; });
+    auto sum    = graph.add_memoized_transform(
+        "expensive sum", cache, [&calls](int x, int y) { return ++calls, x + y; }, source, offset);
+
+    REQUIRE(graph.compile());
+
+    auto results = std::vector<int>();
+    while (tick < inputs.size()) {
+        graph.tick();
+        results.emplace_back(graph.value(sum));
+    }
+
+    CHECK(results == std::vector<int>{101, 102, 101, 102, 103, 101});
+
+    // '3' evicts '1' so the final '1' is recomputed
+    CHECK(calls == 4);
+    CHECK(cache->hits() == 2u);
+    CHECK(cache->misses() == 4u);
+}
+
+TEST_CASE("[ltb][ddf] memoized transforms can share a cache across parallel workers") {
+    using namespace ltb;
+
+    ddf::ddf graph;
+
+    auto tick   = 0;
+    auto cache  = std::make_shared<ddf::MemoCache<int(int)>>(4u);
+    auto source = graph.add_source("source", [&tick] { return tick++ % 8; });
+
+    // Independent nodes on the same cache so the executor can run them at the same time
+    auto outputs = std::vector<ddf::OutputPort<int>>();
+    for (auto i = 0; i < 8; ++i) {
+        outputs.emplace_back(graph.add_memoized_transform(
+            "square " + std::to_string(i), cache, [](int x) { return x * x; }, source));
+    }
+    REQUIRE(graph.compile());
+
+    ddf::ParallelExecutor executor(4u);
+    for (auto t = 0; t < 64; ++t) {
+        graph.tick(executor);
+
+        auto const expected = (t % 8) * (t % 8);
+        for (auto const& output : outputs) {
+            CHECK(graph.value(output) == expected);
+        }
+    }
+
+    CHECK(cache->size() <= cache->capacity());
+    CHECK(cache->hits() + cache->misses() == 64u * 8u);
+}
@@ -0,0 +1,218 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// external
+#include <ltb/util/hash_utils.hpp>
+
+// standard
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace ltb::ddf {
+
+template <typename Signature>
+class MemoCache;
+
+/**
+ * @brief A least-recently-used cache of the results of a pure function.
+ *
+ * Entries are keyed by a hash of the arguments built with 'ltb::util::hash_combine', so
+ * every argument type needs a std::hash specialization. The arguments are stored with the
+ * result and compared on lookup so a hash collision is a miss rather than a wrong result.
+ *
+ * Once the cache is full the least recently used entry is overwritten in place, so a warm
+ * cache does not allocate.
+ *
+ * One cache may be shared by several memoized nodes, including nodes ticked concurrently by
+ * a 'ParallelExecutor'. Lookups and inserts are serialized by a mutex and results are
+ * returned by copy since another thread may reuse the entry. 'func' runs without the lock,
+ * so two threads missing on the same arguments may both compute them.
+ *
+ *     auto cache = std::make_shared<ltb::ddf::MemoCache<Mesh(int, float)>>(16u);
+ *     auto mesh  = graph.add_memoized_transform("mesh", cache, build_mesh, resolution, scale);
+ *
+ * The hit and miss counters may be read from any thread.
+ */
+template <typename R, typename... Args>
+class MemoCache<R(Args...)> {
+public:
+    explicit MemoCache(std::size_t capacity);
+
+    /// \brief Returns the cached result for 'args' or stores and returns 'func(args...)'
+    template <typename Func>
+    auto get_or_compute(Func& func, Args const&... args) -> R;
+
+    /// \brief The cached result for 'args' if there is one. Counts as a hit or miss.
+    auto find(Args const&... args) -> std::optional<R>;
+
+    auto size() const -> std::size_t;
+    auto capacity() const -> std::size_t { return capacity_; }
+
+    auto hits() const -> std::uint64_t { return hits_.load(std::memory_order_relaxed); }
+    auto misses() const -> std::uint64_t { return misses_.load(std::memory_order_relaxed); }
+    auto evictions() const -> std::uint64_t { return evictions_.load(std::memory_order_relaxed); }
+
+    /// \brief Removes every entry. The counters are kept.
+    auto clear() -> void;
+
+    static auto hash(Args const&... args) -> std::size_t;
+
+private:
+    struct Entry {
+        std::size_t         hash;
+        std::tuple<Args...> args;
+        R                   result;
+    };
+    using Iterator = typename std::list<Entry>::iterator;
+
+    auto lookup(std::size_t key, Args const&... args) -> Iterator;
+    auto insert(std::size_t key, Args const&... args, R result) -> R const&;
+
+    mutable std::mutex                        mutex_; ///< Guards the entries and index
+    std::size_t                               capacity_;
+    std::list<Entry>                          entries_; ///< Most recently used first
+    std::unordered_map<std::size_t, Iterator> index_; ///< Entries by argument hash
+
+    std::atomic<std::uint64_t> hits_{0u};
+    std::atomic<std::uint64_t> misses_{0u};
+    std::atomic<std::uint64_t> evictions_{0u};
+};
+
+template <typename R, typename... Args>
+MemoCache<R(Args...)>::MemoCache(std::size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0u) {
+        throw std::invalid_argument("MemoCache capacity must be positive");
+    }
+    index_.reserve(capacity_);
+}
+
+template <typename R, typename... Args>
+template <typename Func>
+auto MemoCache<R(Args...)>::get_or_compute(Func& func, Args const&... args) -> R {
+    auto const key = hash(args...);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto entry = lookup(key, args...); entry != entries_.end()) {
+            hits_.fetch_add(1u, std::memory_order_relaxed);
+            return entry->result;
+        }
+    }
+    misses_.fetch_add(1u, std::memory_order_relaxed);
+
+    auto result = func(args...);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Another thread may have stored the same arguments while 'func' was running
+    if (auto entry = lookup(key, args...); entry != entries_.end()) {
+        return entry->result;
+    }
+    return insert(key, args..., std::move(result));
+}
+
+template <typename R, typename... Args>
+auto MemoCache<R(Args...)>::find(Args const&... args) -> std::optional<R> {
+    auto const key = hash(args...);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto                        entry = lookup(key, args...);
+
+    if (entry == entries_.end()) {
+        misses_.fetch_add(1u, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    hits_.fetch_add(1u, std::memory_order_relaxed);
+    return entry->result;
+}
+
+template <typename R, typename... Args>
+auto MemoCache<R(Args...)>::size() const -> std::size_t {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+template <typename R, typename... Args>
+auto MemoCache<R(Args...)>::clear() -> void {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+}
+
+template <typename R, typename... Args>
+auto MemoCache<R(Args...)>::hash(Args const&... args) -> std::size_t {
+    auto seed = std::size_t{0u};
+    ((seed = util::hash_combine(seed, args)), ...);
+    return seed;
+}
+
+template <typename R, typename... Args>
+auto MemoCache<R(Args...)>::lookup(std::size_t key, Args const&... args) -> Iterator {
+    auto indexed = index_.find(key);
+
+    if (indexed == index_.end() || indexed->second->args != std::tie(args...)) {
+        return entries_.end();
+    }
+
+    // Mark as most recently used
+    entries_.splice(entries_.begin(), entries_, indexed->second);
+    return indexed->second;
+}
+
+template <typename R, typename... Args>
+auto MemoCache<R(Args...)>::insert(std::size_t key, Args const&... args, R result) -> R const& {
+    if (entries_.size() < capacity_) {
+        entries_.push_front(Entry{key, std::tuple<Args...>(args...), std::move(result)});
+    } else {
+        // Reuse the least recently used entry
+        auto  last   = std::prev(entries_.end());
+        auto& oldest = *last;
+
+        // The index may point at a newer entry that collided with this one
+        if (auto indexed = index_.find(oldest.hash); indexed != index_.end() && indexed->second == last) {
+            index_.erase(indexed);
+        }
+        oldest.hash   = key;
+        oldest.args   = std::tuple<Args...>(args...);
+        oldest.result = std::move(result);
+        entries_.splice(entries_.begin(), entries_, last);
+        evictions_.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    // A colliding entry for a different argument set is replaced in the index (and ages out of the list)
+    index_[key] = entries_.begin();
+    return entries_.front().result;
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,175 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "arena.hpp"
+#include "events.hpp"
+#include "ports.hpp"
+#include "profiler.hpp"
+
+// standard
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ltb::ddf {
+namespace detail {
+
+template <typename T, typename = void>
+struct is_equality_comparable : std::false_type {};
+
+template <typename T>
+struct is_equality_comparable<T, std::void_t<decltype(std::declval<T const&>() == std::declval<T const&>())>>
+    : std::true_type {};
+
+} // namespace detail
+
+/// \brief How a compiled graph decides which nodes to run each tick
+enum class EvaluationMode {
+    Full, ///< Every node runs every tick
+    Incremental, ///< Nodes only run when the version of one of their inputs changed
+};
+
+/**
+ * @brief The view of the compiled slot buffer handed to a node body when it executes.
+ *
+ * Inputs and outputs are plain offsets into the graph's contiguous slot buffer so reading
+ * an input is a single pointer add and no per-connection callbacks are involved.
+ *
+ * Event ports store an EventBuffer holding every event fired during the tick, so a
+ * batch of events is delivered to each reader with a single call ('events'/'event_output').
+ *
+ * Every output also carries a version stamp (the tick it last changed) which drives
+ * incremental evaluation. 'output' conservatively stamps the output as changed while
+ * 'set_output' only does so when the new value differs from the cached one.
+ *
+ * A node that is waiting on asynchronous work calls 'wake_next_tick' so it is polled again
+ * next tick rather than blocking the worker until the work finishes.
+ *
+ * 'scratch' is a bump allocator for temporaries that only live until the body returns.
+ * It is reset at the start of every tick so it stops allocating once warmed up.
+ */
+class NodeContext {
+public:
+    NodeContext(std::byte*         slots,
+                std::size_t const* input_offsets,
+                std::size_t const* output_offsets,
+                std::uint64_t*     output_versions,
+                std::uint64_t const* versions,
+                std::size_t const* input_slots,
+                std::uint8_t*      wake,
+                std::uint64_t      tick,
+                bool               compare_outputs,
+                Arena*             scratch,
+                Profiler*          profiler)
+        : slots_(slots),
+          input_offsets_(input_offsets),
+          output_offsets_(output_offsets),
+          output_versions_(output_versions),
+          versions_(versions),
+          input_slots_(input_slots),
+          wake_(wake),
+          tick_(tick),
+          compare_outputs_(compare_outputs),
+          scratch_(scratch),
+          profiler_(profiler) {}
+
+    /// \brief The current value of the output connected to input 'index'
+    template <typename T>
+    auto input(PortIndex index) const -> T const& {
+        return *std::launder(reinterpret_cast<T const*>(slots_ + input_offsets_[index]));
+    }
+
+    /// \brief The tick the output connected to input 'index' last changed
+    auto input_version(PortIndex index) const -> std::uint64_t { return versions_[input_slots_[index]]; }
+
+    /// \brief The value stored for output 'index'. Downstream nodes read it after this node runs.
+    template <typename T>
+    auto output(PortIndex index) -> T& {
+        output_versions_[index] = tick_;
+        return *std::launder(reinterpret_cast<T*>(slots_ + output_offsets_[index]));
+    }
+
+    /// \brief Stores 'value' in output 'index'. In incremental mode the output is left untouched
+    ///        (and downstream nodes are not re-run) if 'value' equals the cached value.
+    template <typename T, typename U>
+    auto set_output(PortIndex index, U&& value) -> void {
+        auto& cached = *std::launder(reinterpret_cast<T*>(slots_ + output_offsets_[index]));
+
+        if constexpr (detail::is_equality_comparable<T>::value) {
+            if (compare_outputs_ && output_versions_[index] != 0u && cached == value) {
+                return;
+            }
+        }
+        cached                  = std::forward<U>(value);
+        output_versions_[index] = tick_;
+    }
+
+    /// \brief The events fired this tick on the event port connected to input 'index'. Events
+    ///        left over from earlier ticks (when the producer was skipped) are not returned.
+    template <typename T>
+    auto events(PortIndex index) const -> Span<T const> {
+        auto const& buffer = input<EventBuffer<T>>(index);
+        return buffer.tick() == tick_ ? buffer.events() : Span<T const>{};
+    }
+
+    /// \brief The buffer to fire events into for event output 'index'. The buffer is cleared of
+    ///        events from previous ticks the first time it is requested each tick.
+    template <typename T>
+    auto event_output(PortIndex index) -> EventBuffer<T>& {
+        auto& buffer = output<EventBuffer<T>>(index);
+        buffer.begin_tick(tick_);
+        return buffer;
+    }
+
+    /// \brief Runs this node again next tick even if none of its inputs change (in incremental mode).
+    ///        Used by nodes waiting on asynchronous work so they can poll it without blocking.
+    auto wake_next_tick() -> void { *wake_ = 1u; }
+
+    /// \brief The number of the tick currently being executed (starting at 1)
+    auto tick() const -> std::uint64_t { return tick_; }
+
+    /// \brief Per-tick temporary memory. Everything allocated here is released at the next tick.
+    auto scratch() const -> Arena& { return *scratch_; }
+
+    /// \brief The graph's profiler or null if profiling is disabled
+    auto profiler() const -> Profiler* { return profiler_; }
+
+private:
+    std::byte*         slots_;
+    std::size_t const* input_offsets_;
+    std::size_t const* output_offsets_;
+    std::uint64_t*     output_versions_;
+    std::uint64_t const* versions_; ///< Every output version in the graph
+    std::size_t const* input_slots_; ///< Index into 'versions_' for each input
+    std::uint8_t*      wake_;
+    std::uint64_t      tick_;
+    bool               compare_outputs_;
+    Arena*             scratch_;
+    Profiler*          profiler_;
+};
+
+} // namespace ltb::ddf
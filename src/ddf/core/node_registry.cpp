@@ -0,0 +1,41 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "node_registry.hpp"
+
+namespace ltb::ddf {
+
+auto NodeTypeRegistry::add_factory(std::string type, std::size_t param_size, Factory create) -> void {
+    auto name = type;
+    types_.insert_or_assign(std::move(type), NodeType{std::move(name), param_size, std::move(create)});
+}
+
+auto NodeTypeRegistry::find(std::string const& type) const -> NodeType const* {
+    auto iter = types_.find(type);
+    return iter == types_.end() ? nullptr : &iter->second;
+}
+
+auto NodeTypeRegistry::size() const -> std::size_t {
+    return types_.size();
+}
+
+} // namespace ltb::ddf
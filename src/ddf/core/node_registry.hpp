@@ -0,0 +1,120 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf.hpp"
+#include "events.hpp"
+
+// standard
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief Copies a trivially copyable parameter struct into the bytes stored in a graph file
+template <typename Params>
+auto encode_params(Params const& params) -> std::vector<std::byte> {
+    static_assert(std::is_trivially_copyable_v<Params>, "Node parameters must be trivially copyable");
+
+    std::vector<std::byte> bytes(sizeof(Params));
+    std::memcpy(bytes.data(), &params, sizeof(Params));
+    return bytes;
+}
+
+/**
+ * @brief Maps the node type ids used in serialized graphs to functions that add those nodes.
+ *
+ * Each type declares its port types and builds a node body from its parameters. Types with
+ * a parameter struct have the size of their parameters checked before they are created:
+ *
+ *     ltb::ddf::NodeTypeRegistry registry;
+ *
+ *     registry.add_type("math/add", Inputs<int, int>{}, Outputs<int>{}, [] {
+ *         return [](NodeContext& ctx) { ctx.output<int>(0) = ctx.input<int>(0) + ctx.input<int>(1); };
+ *     });
+ *     registry.add_type<Scale>("math/scale", Inputs<int>{}, Outputs<int>{}, [](Scale const& scale) {
+ *         return [factor = scale.factor](NodeContext& ctx) { ctx.output<int>(0) = ctx.input<int>(0) * factor; };
+ *     });
+ */
+class NodeTypeRegistry {
+public:
+    /// \brief Adds a node named 'name' to 'graph' and returns its id
+    using Factory = std::function<NodeId(ddf& graph, std::string name, Span<std::byte const> params)>;
+
+    /// \brief The parameter size of types that accept parameters of any size
+    static constexpr auto any_param_size = std::numeric_limits<std::size_t>::max();
+
+    struct NodeType {
+        std::string name;
+        std::size_t param_size; ///< The exact size of the parameters or 'any_param_size'
+        Factory     create;
+    };
+
+    /// \brief Registers a type whose body is built without parameters by 'make()'
+    template <typename... Ins, typename... Outs, typename Make>
+    auto add_type(std::string type, Inputs<Ins...>, Outputs<Outs...>, Make make) -> void;
+
+    /// \brief Registers a type whose body is built by 'make(Params const&)'
+    template <typename Params, typename... Ins, typename... Outs, typename Make>
+    auto add_type(std::string type, Inputs<Ins...>, Outputs<Outs...>, Make make) -> void;
+
+    /// \brief Registers a type with a custom factory. 'param_size' is checked before 'create' is called.
+    auto add_factory(std::string type, std::size_t param_size, Factory create) -> void;
+
+    /// \brief The type registered as 'type' or null
+    auto find(std::string const& type) const -> NodeType const*;
+
+    auto size() const -> std::size_t;
+
+private:
+    std::unordered_map<std::string, NodeType> types_;
+};
+
+template <typename... Ins, typename... Outs, typename Make>
+auto NodeTypeRegistry::add_type(std::string type, Inputs<Ins...>, Outputs<Outs...>, Make make) -> void {
+    add_factory(std::move(type), 0u, [make = std::move(make)](ddf& graph, std::string name, Span<std::byte const>) {
+        return graph.add_node(std::move(name), Inputs<Ins...>{}, Outputs<Outs...>{}, make()).id();
+    });
+}
+
+template <typename Params, typename... Ins, typename... Outs, typename Make>
+auto NodeTypeRegistry::add_type(std::string type, Inputs<Ins...>, Outputs<Outs...>, Make make) -> void {
+    static_assert(std::is_trivially_copyable_v<Params>, "Node parameters must be trivially copyable");
+
+    add_factory(std::move(type),
+                sizeof(Params),
+                [make = std::move(make)](ddf& graph, std::string name, Span<std::byte const> bytes) {
+                    Params params;
+                    std::memcpy(&params, bytes.data(), sizeof(Params));
+                    return graph.add_node(std::move(name), Inputs<Ins...>{}, Outputs<Outs...>{}, make(params)).id();
+                });
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,144 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "arena.hpp"
+#include "node_context.hpp"
+#include "ports.hpp"
+#include "type_ops.hpp"
+
+// standard
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ltb::ddf {
+
+/**
+ * @brief A move-only, type-erased node body whose callable lives in an Arena.
+ *
+ * Bodies are constructed in the graph's node arena instead of individually on the heap
+ * and 'relocate' moves a body into another arena. Compiling a graph relocates every body
+ * into a fresh arena in execution order so a tick walks node state front to back.
+ */
+class NodeBody {
+public:
+    NodeBody() = default;
+
+    template <typename Func>
+    NodeBody(Arena& arena, Func&& func);
+
+    ~NodeBody() { reset(); }
+
+    NodeBody(NodeBody const&) = delete;
+    auto operator=(NodeBody const&) -> NodeBody& = delete;
+
+    NodeBody(NodeBody&& other) noexcept
+        : state_(std::exchange(other.state_, nullptr)), ops_(std::exchange(other.ops_, nullptr)) {}
+
+    auto operator=(NodeBody&& other) noexcept -> NodeBody& {
+        if (this != &other) {
+            reset();
+            state_ = std::exchange(other.state_, nullptr);
+            ops_   = std::exchange(other.ops_, nullptr);
+        }
+        return *this;
+    }
+
+    auto operator()(NodeContext& ctx) -> void { ops_->invoke(state_, ctx); }
+
+    /// \brief Move constructs the callable into 'arena' and destroys the old instance.
+    ///        The old memory is reclaimed when its arena is destroyed.
+    auto relocate(Arena& arena) -> void {
+        if (!ops_) {
+            return;
+        }
+        auto* state = arena.allocate(ops_->size, ops_->alignment);
+        ops_->move_construct(state, state_);
+        ops_->destroy(state_);
+        state_ = state;
+    }
+
+    /// \brief The address of the stored callable
+    auto state() const -> void const* { return state_; }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+private:
+    struct Ops {
+        std::size_t size;
+        std::size_t alignment;
+        void (*invoke)(void* state, NodeContext& ctx);
+        void (*move_construct)(void* dst, void* src);
+        void (*destroy)(void* state);
+    };
+
+    template <typename Func>
+    static auto ops() -> Ops const&;
+
+    auto reset() -> void {
+        if (ops_) {
+            ops_->destroy(state_);
+        }
+        state_ = nullptr;
+        ops_   = nullptr;
+    }
+
+    void*      state_ = nullptr;
+    Ops const* ops_   = nullptr;
+};
+
+template <typename Func>
+NodeBody::NodeBody(Arena& arena, Func&& func) : ops_(&ops<std::decay_t<Func>>()) {
+    using F = std::decay_t<Func>;
+    state_  = arena.allocate(sizeof(F), alignof(F));
+    ::new (state_) F(std::forward<Func>(func));
+}
+
+template <typename Func>
+auto NodeBody::ops() -> Ops const& {
+    static_assert(std::is_move_constructible_v<Func>, "Node bodies must be move constructible");
+
+    static Ops const ops = {
+        sizeof(Func),
+        alignof(Func),
+        [](void* state, NodeContext& ctx) { (*static_cast<Func*>(state))(ctx); },
+        [](void* dst, void* src) { ::new (dst) Func(std::move(*static_cast<Func*>(src))); },
+        [](void* state) { static_cast<Func*>(state)->~Func(); },
+    };
+    return ops;
+}
+
+/// \brief Everything the graph knows about a node before it is compiled
+struct NodeSpec {
+    std::string                 name;
+    std::vector<TypeOps const*> input_types;
+    std::vector<TypeOps const*> output_types;
+    std::vector<PortRef>        input_sources; ///< The output connected to each input (if any)
+    NodeBody                    body;
+};
+
+} // namespace ltb::ddf
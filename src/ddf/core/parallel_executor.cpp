@@ -0,0 +1,376 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "parallel_executor.hpp"
+
+// project
+#include "ddf.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+
+namespace ltb::ddf {
+
+/// \brief A fixed capacity double-ended ring of unit indices
+struct ParallelExecutor::WorkerQueue {
+    std::mutex               mutex;
+    std::vector<std::size_t> ring;
+    std::size_t              head = 0u;
+    std::size_t              size = 0u;
+
+    auto reset(std::size_t capacity) -> void {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ring.size() < capacity) {
+            ring.resize(capacity);
+        }
+        head = 0u;
+        size = 0u;
+    }
+
+    auto push_back(std::size_t unit) -> void {
+        std::lock_guard<std::mutex> lock(mutex);
+        ring[(head + size++) % ring.size()] = unit;
+    }
+
+    auto pop_back(std::size_t* unit) -> bool {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (size == 0u) {
+            return false;
+        }
+        *unit = ring[(head + --size) % ring.size()];
+        return true;
+    }
+
+    auto pop_front(std::size_t* unit) -> bool {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (size == 0u) {
+            return false;
+        }
+        *unit = ring[head];
+        head  = (head + 1u) % ring.size();
+        --size;
+        return true;
+    }
+};
+
+ParallelExecutor::ParallelExecutor(std::size_t worker_count) {
+    if (worker_count == 0u) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (auto i = 0u; i < worker_count; ++i) {
+        queues_.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    for (auto i = 1u; i < worker_count; ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ParallelExecutor::~ParallelExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_condition_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+auto ParallelExecutor::run(ExecutionPlan& plan) -> void {
+    auto const  unit_count   = plan.units().size();
+    auto const& dependencies = plan.unit_dependencies();
+
+    if (unit_count == 0u) {
+        return;
+    }
+
+    if (remaining_capacity_ < unit_count) {
+        remaining_inputs_   = std::make_unique<std::atomic<std::uint32_t>[]>(unit_count);
+        remaining_capacity_ = unit_count;
+    }
+
+    for (auto& queue : queues_) {
+        queue->reset(unit_count);
+    }
+
+    // Seed the units that have no inputs round-robin across the workers.
+    auto seed_worker = std::size_t{0u};
+
+    for (auto u = 0u; u < unit_count; ++u) {
+        remaining_inputs_[u].store(dependencies[u], std::memory_order_relaxed);
+
+        if (dependencies[u] == 0u) {
+            queues_[seed_worker]->push_back(u);
+            seed_worker = (seed_worker + 1u) % queues_.size();
+        }
+    }
+
+    plan.reserve_workers(queues_.size());
+    plan.begin_tick();
+    units_left_.store(unit_count, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        plan_         = &plan;
+        busy_workers_ = threads_.size();
+        ++generation_;
+    }
+    wake_condition_.notify_all();
+
+    work(0u);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_condition_.wait(lock, [this] { return busy_workers_ == 0u; });
+        plan_ = nullptr;
+    }
+
+    if (error_) {
+        auto error = std::exchange(error_, nullptr);
+        std::rethrow_exception(error);
+    }
+}
+
+auto ParallelExecutor::worker_count() const -> std::size_t {
+    return queues_.size();
+}
+
+auto ParallelExecutor::worker_loop(std::size_t worker) -> void {
+    auto generation = std::uint64_t{0u};
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_condition_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+
+            if (stopping_) {
+                return;
+            }
+            generation = generation_;
+        }
+
+        work(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0u) {
+                done_condition_.notify_one();
+            }
+        }
+    }
+}
+
+auto ParallelExecutor::work(std::size_t worker) -> void {
+    // Idle workers spin briefly in case a unit is about to become ready, then sleep until one is
+    constexpr auto max_spins = 64u;
+
+    auto const& successor_begin = plan_->unit_successor_begin();
+    auto const& successors      = plan_->unit_successors();
+
+    auto spins = 0u;
+
+    while (units_left_.load(std::memory_order_acquire) > 0u) {
+        auto const ready_count = ready_count_.load(std::memory_order_seq_cst);
+        auto       unit        = std::size_t{0u};
+
+        if (!next_unit(worker, &unit)) {
+            if (++spins < max_spins) {
+                std::this_thread::yield();
+            } else {
+                wait_for_units(ready_count);
+                spins = 0u;
+            }
+            continue;
+        }
+        spins = 0u;
+
+        // Once a node has thrown the remaining units are only counted down, not run
+        if (!failed_.load(std::memory_order_acquire)) {
+            try {
+                plan_->run_unit(unit, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true, std::memory_order_release);
+            }
+        }
+
+        // Successors become ready once their last input has been produced.
+        auto ready = std::size_t{0u};
+        for (auto s = successor_begin[unit]; s < successor_begin[unit + 1u]; ++s) {
+            if (remaining_inputs_[successors[s]].fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+                queues_[worker]->push_back(successors[s]);
+                ++ready;
+            }
+        }
+
+        if (units_left_.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+            // Wake everyone so they see the run is over
+            wake_workers(queues_.size());
+        } else if (ready > 0u) {
+            wake_workers(ready);
+        }
+    }
+}
+
+auto ParallelExecutor::wait_for_units(std::uint64_t ready_count) -> void {
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    idle_workers_.fetch_add(1u, std::memory_order_seq_cst);
+
+    // 'ready_count' was read before looking for a unit so anything pushed since then changes it
+    idle_condition_.wait(lock, [this, ready_count] {
+        return ready_count_.load(std::memory_order_seq_cst) != ready_count
+            || units_left_.load(std::memory_order_acquire) == 0u;
+    });
+
+    idle_workers_.fetch_sub(1u, std::memory_order_relaxed);
+}
+
+auto ParallelExecutor::wake_workers(std::size_t unit_count) -> void {
+    ready_count_.fetch_add(1u, std::memory_order_seq_cst);
+
+    // Either the idle worker sees the new 'ready_count_' before sleeping or it is counted here
+    if (idle_workers_.load(std::memory_order_seq_cst) == 0u) {
+        return;
+    }
+
+    {
+        // Waiting workers check 'ready_count_' while holding the lock so this can't be missed
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+    }
+
+    if (unit_count == 1u) {
+        idle_condition_.notify_one();
+    } else {
+        idle_condition_.notify_all();
+    }
+}
+
+auto ParallelExecutor::next_unit(std::size_t worker, std::size_t* unit) -> bool {
+    if (queues_[worker]->pop_back(unit)) {
+        return true;
+    }
+
+    for (auto i = 1u; i < queues_.size(); ++i) {
+        if (queues_[(worker + i) % queues_.size()]->pop_front(unit)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("[ltb][ddf] parallel executor matches serial execution") {
+    for (auto workers : {1u, 2u, 4u, 7u}) {
+        ddf graph;
+
+        auto source = graph.add_source("source", [i = 0]() mutable { return ++i; });
+
+        // Many independent branches joined by a long chain of sums
+        std::vector<OutputPort<long>> branches;
+        for (auto b = 0; b < 200; ++b) {
+            auto branch = graph.add_transform("branch", [b](int x) { return static_cast<long>(x) * b; }, source);
+            branches.emplace_back(graph.add_transform("square", [](long x) { return x * x; }, branch));
+        }
+
+        auto total = graph.add_transform("total", [](long x, long y) { return x + y; }, branches[0], branches[1]);
+        for (auto b = 2u; b < branches.size(); ++b) {
+            total = graph.add_transform("total", [](long x, long y) { return x + y; }, total, branches[b]);
+        }
+
+        REQUIRE(graph.compile());
+
+        ParallelExecutor executor(workers);
+        CHECK(executor.worker_count() == workers);
+
+        for (auto tick = 1l; tick <= 5l; ++tick) {
+            graph.tick(executor);
+
+            auto expected = 0l;
+            for (auto b = 0l; b < 200l; ++b) {
+                expected += (tick * b) * (tick * b);
+            }
+            CHECK(graph.value(total) == expected);
+        }
+    }
+}
+
+TEST_CASE("[ltb][ddf] parallel executor wakes idle workers") {
+    ddf graph;
+
+    // A slow node keeps the other workers idle long enough to park them. They must be woken
+    // both for the units it makes ready and for the end of the tick.
+    auto slow = graph.add_source("slow", [i = 0]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return ++i;
+    });
+
+    std::vector<OutputPort<int>> branches;
+    for (auto b = 0; b < 16; ++b) {
+        branches.emplace_back(graph.add_transform("branch", [b](int x) { return x + b; }, slow));
+    }
+
+    auto total = graph.add_transform("total", [](int x, int y) { return x + y; }, branches[0], branches[1]);
+    for (auto b = 2u; b < branches.size(); ++b) {
+        total = graph.add_transform("total", [](int x, int y) { return x + y; }, total, branches[b]);
+    }
+
+    REQUIRE(graph.compile());
+
+    ParallelExecutor executor(4u);
+
+    for (auto tick = 1; tick <= 3; ++tick) {
+        graph.tick(executor);
+        CHECK(graph.value(total) == 16 * tick + 120);
+    }
+}
+
+TEST_CASE("[ltb][ddf] parallel executor rethrows node exceptions") {
+    ddf graph;
+
+    auto ran_after = false;
+
+    auto source = graph.add_source("source", []() -> int { throw std::runtime_error("blarg"); });
+    auto other  = graph.add_source("other", [] { return 1; });
+    graph.add_sink("sink", [&ran_after](int, int) { ran_after = true; }, source, other);
+
+    REQUIRE(graph.compile());
+
+    ParallelExecutor executor(3u);
+    CHECK_THROWS(graph.tick(executor));
+    // Like serial execution, nothing depending on the failed node runs
+    CHECK_FALSE(ran_after);
+
+    // The executor is still usable after an exception
+    CHECK_THROWS(graph.tick(executor));
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,106 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "execution_plan.hpp"
+
+// standard
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ltb::ddf {
+
+/**
+ * @brief Runs a compiled plan across a pool of work-stealing threads.
+ *
+ * The plan's execution units (single steps or fused chains) are the tasks. Each unit
+ * carries a counter of unresolved inputs. Units with no inputs are seeded across the
+ * worker queues and whenever a unit finishes it decrements the counters of the units
+ * reading its outputs, pushing any that become ready onto its own queue.
+ * Workers pop from the back of their own queue and steal from the front of the others
+ * so independent branches of a graph spread across all cores during a single tick.
+ *
+ *     ltb::ddf::ParallelExecutor executor(8);
+ *     graph.tick(executor);
+ */
+class ParallelExecutor {
+public:
+    /// \brief 'worker_count' includes the calling thread. Zero uses every hardware thread.
+    explicit ParallelExecutor(std::size_t worker_count = 0u);
+    ~ParallelExecutor();
+
+    ParallelExecutor(ParallelExecutor const&) = delete;
+    ParallelExecutor(ParallelExecutor&&)      = delete;
+    auto operator=(ParallelExecutor const&) -> ParallelExecutor& = delete;
+    auto operator=(ParallelExecutor&&) -> ParallelExecutor& = delete;
+
+    /// \brief Executes every step of 'plan' once and blocks until all of them have finished.
+    ///        If a node throws, no further steps are started (like 'ExecutionPlan::run') and the
+    ///        first exception is rethrown once the running steps have finished.
+    auto run(ExecutionPlan& plan) -> void;
+
+    /// \brief The number of threads (including the caller) that execute steps
+    auto worker_count() const -> std::size_t;
+
+private:
+    struct WorkerQueue;
+
+    auto worker_loop(std::size_t worker) -> void;
+    auto work(std::size_t worker) -> void;
+    auto next_unit(std::size_t worker, std::size_t* unit) -> bool;
+    auto wait_for_units(std::uint64_t ready_count) -> void;
+    auto wake_workers(std::size_t unit_count) -> void;
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_; ///< One queue per worker
+    std::vector<std::thread>                  threads_; ///< Background workers (the caller is worker 0)
+
+    ExecutionPlan*                                plan_ = nullptr; ///< The plan currently being run
+    std::unique_ptr<std::atomic<std::uint32_t>[]> remaining_inputs_; ///< Unresolved inputs per unit
+    std::size_t                                   remaining_capacity_ = 0u; ///< Size of 'remaining_inputs_'
+    std::atomic<std::size_t>                      units_left_{0u}; ///< Units not yet finished this run
+
+    std::mutex         error_mutex_;
+    std::exception_ptr error_; ///< The first exception thrown by a node this run
+    std::atomic<bool>  failed_{false}; ///< Set with 'error_' so the remaining units are skipped
+
+    std::mutex                 idle_mutex_;
+    std::condition_variable    idle_condition_; ///< Wakes idle workers when units become ready
+    std::atomic<std::uint64_t> ready_count_{0u}; ///< Incremented when units become ready or the run ends
+    std::atomic<std::size_t>   idle_workers_{0u}; ///< Workers waiting on 'idle_condition_'
+
+    std::mutex              mutex_;
+    std::condition_variable wake_condition_; ///< Signals the workers when a new run starts
+    std::condition_variable done_condition_; ///< Signals the caller when the workers are idle
+    std::uint64_t           generation_   = 0u; ///< Incremented once per run
+    std::size_t             busy_workers_ = 0u; ///< Background workers still in the current run
+    bool                    stopping_     = false;
+};
+
+} // namespace ltb::ddf
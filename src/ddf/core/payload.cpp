@@ -0,0 +1,138 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "payload.hpp"
+
+// project
+#include "ddf.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+TEST_CASE("[ltb][ddf] payload pool recycles storage") {
+    using namespace ltb;
+
+    ddf::PayloadPool<float> pool;
+
+    auto builder = pool.acquire(1000u);
+    std::iota(builder.data(), builder.data() + builder.size(), 0.f);
+    auto const* storage = builder.data();
+
+    auto payload = std::move(builder).freeze();
+    CHECK(payload.size() == 1000u);
+    CHECK(payload[999] == 999.f);
+    CHECK(payload.use_count() == 1u);
+
+    {
+        auto copy = payload;
+        CHECK(copy == payload);
+        CHECK(copy.data() == storage);
+        CHECK(payload.use_count() == 2u);
+    }
+    CHECK(payload.use_count() == 1u);
+    CHECK(pool.free_count() == 0u);
+
+    payload = {};
+    CHECK(pool.free_count() == 1u);
+
+    // The same storage is handed out again
+    auto reused = pool.acquire(10u);
+    CHECK(reused.data() == storage);
+    CHECK(pool.allocated_count() == 1u);
+
+    // Builders that are never frozen go straight back to the pool
+    {
+        auto unused = pool.acquire(5u);
+    }
+    CHECK(pool.free_count() == 1u);
+
+    // Unpooled payloads are simply freed
+    auto plain = ddf::Payload<float>(std::vector<float>{1.f, 2.f});
+    CHECK(plain.size() == 2u);
+    CHECK(plain != ddf::Payload<float>(std::vector<float>{1.f, 2.f}));
+}
+
+TEST_CASE("[ltb][ddf] payloads fan out without copies") {
+    using namespace ltb;
+
+    ddf::PayloadPool<float> pool;
+    ddf::ddf                graph;
+
+    auto cloud = graph.add_source("cloud", [&pool, i = 0.f]() mutable {
+        auto points = pool.acquire(4096u);
+        std::fill(points.data(), points.data() + points.size(), ++i);
+        return std::move(points).freeze();
+    });
+
+    auto seen = std::vector<float const*>(4u);
+    for (auto s = 0u; s < seen.size(); ++s) {
+        graph.add_sink("sink", [&seen, s](ddf::Payload<float> const& points) { seen[s] = points.data(); }, cloud);
+    }
+    REQUIRE(graph.compile());
+
+    for (auto tick = 0; tick < 10; ++tick) {
+        graph.tick();
+
+        CHECK(graph.value(cloud).use_count() == 1u);
+        for (auto const* data : seen) {
+            CHECK(data == graph.value(cloud).data());
+        }
+    }
+
+    // The next buffer is acquired while the slot still holds the previous one
+    CHECK(pool.allocated_count() == 2u);
+    CHECK(graph.value(cloud)[0] == 10.f);
+}
+
+TEST_CASE("[ltb][ddf] payloads released on other threads") {
+    using namespace ltb;
+
+    auto pool    = std::make_unique<ddf::PayloadPool<int>>();
+    auto payload = pool->acquire(100u).freeze();
+
+    auto totals  = std::vector<int>(4u);
+    auto readers = std::vector<std::thread>();
+    for (auto t = 0u; t < totals.size(); ++t) {
+        readers.emplace_back([copy = payload, &total = totals[t]]() mutable {
+            total = std::accumulate(copy.begin(), copy.end(), 0);
+            copy  = {};
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(payload.use_count() == 1u);
+    CHECK(totals == std::vector<int>(4u, 0));
+
+    payload = {};
+    CHECK(pool->free_count() == 1u);
+
+    // Payloads may outlive their pool
+    auto orphan = pool->acquire(10u).freeze();
+    pool.reset();
+    CHECK(orphan.size() == 10u);
+}
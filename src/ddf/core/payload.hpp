@@ -0,0 +1,331 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "events.hpp"
+
+// standard
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ltb::ddf {
+namespace detail {
+
+template <typename T>
+struct PayloadPoolState;
+
+/// \brief The storage shared by every copy of a Payload
+template <typename T>
+struct PayloadBlock {
+    std::vector<T>                       data;
+    std::atomic<std::uint32_t>           refs{0u};
+    std::shared_ptr<PayloadPoolState<T>> pool; ///< Null for storage that is freed instead of recycled
+};
+
+template <typename T>
+struct PayloadPoolState {
+    std::mutex                                    mutex;
+    std::vector<std::unique_ptr<PayloadBlock<T>>> free_blocks;
+    std::size_t                                   max_free_blocks;
+    std::size_t                                   allocated = 0u; ///< Blocks created by the pool
+
+    auto recycle(std::unique_ptr<PayloadBlock<T>> block) -> void;
+};
+
+} // namespace detail
+
+template <typename T>
+class PayloadBuilder;
+
+/**
+ * @brief An immutable, reference counted buffer of T.
+ *
+ * Copying a Payload only bumps an atomic reference count, so a large buffer (a tensor, a
+ * point cloud, an image) produced by one node is read by any number of downstream nodes
+ * and sent across region channels without being copied. The buffer can't be modified
+ * once it is shared.
+ *
+ * Payloads come from a PayloadPool and their storage goes back to the pool (keeping its
+ * capacity) when the last copy is dropped, on whichever thread that happens:
+ *
+ *     ltb::ddf::PayloadPool<float> pool;
+ *
+ *     auto cloud = graph.add_source("cloud", [&pool] {
+ *         auto points = pool.acquire(point_count);
+ *         fill(points.data(), points.size());
+ *         return std::move(points).freeze();
+ *     });
+ *
+ * Two payloads compare equal only if they share a buffer, so incremental evaluation treats
+ * each new buffer as a change without comparing the contents.
+ */
+template <typename T>
+class Payload {
+public:
+    /// \brief An empty payload
+    Payload() = default;
+
+    /// \brief A payload that frees 'data' when the last copy is dropped instead of recycling it
+    explicit Payload(std::vector<T> data);
+
+    ~Payload() { release(); }
+
+    Payload(Payload const& other) noexcept : block_(other.block_) { retain(); }
+    Payload(Payload&& other) noexcept : block_(std::exchange(other.block_, nullptr)) {}
+
+    auto operator=(Payload const& other) noexcept -> Payload&;
+    auto operator=(Payload&& other) noexcept -> Payload&;
+
+    auto data() const -> T const* { return block_ ? block_->data.data() : nullptr; }
+    auto size() const -> std::size_t { return block_ ? block_->data.size() : 0u; }
+    auto empty() const -> bool { return size() == 0u; }
+    auto span() const -> Span<T const> { return {data(), size()}; }
+
+    auto begin() const -> T const* { return data(); }
+    auto end() const -> T const* { return data() + size(); }
+
+    auto operator[](std::size_t index) const -> T const& { return block_->data[index]; }
+
+    /// \brief The number of payloads sharing this buffer
+    auto use_count() const -> std::uint32_t { return block_ ? block_->refs.load(std::memory_order_relaxed) : 0u; }
+
+    friend auto operator==(Payload const& lhs, Payload const& rhs) -> bool { return lhs.block_ == rhs.block_; }
+    friend auto operator!=(Payload const& lhs, Payload const& rhs) -> bool { return lhs.block_ != rhs.block_; }
+
+private:
+    friend class PayloadBuilder<T>;
+
+    explicit Payload(detail::PayloadBlock<T>* block) : block_(block) { retain(); }
+
+    auto retain() -> void;
+    auto release() -> void;
+
+    detail::PayloadBlock<T>* block_ = nullptr;
+};
+
+/**
+ * @brief Exclusive, writable storage from a PayloadPool. 'freeze' turns it into a Payload.
+ *        Storage that is never frozen goes straight back to the pool.
+ */
+template <typename T>
+class PayloadBuilder {
+public:
+    ~PayloadBuilder();
+
+    PayloadBuilder(PayloadBuilder const&) = delete;
+    auto operator=(PayloadBuilder const&) -> PayloadBuilder& = delete;
+
+    PayloadBuilder(PayloadBuilder&& other) noexcept : block_(std::move(other.block_)) {}
+    auto operator=(PayloadBuilder&& other) noexcept -> PayloadBuilder&;
+
+    auto data() -> T* { return block_->data.data(); }
+    auto size() const -> std::size_t { return block_->data.size(); }
+    auto operator[](std::size_t index) -> T& { return block_->data[index]; }
+
+    /// \brief The underlying vector, e.g. to resize it. Its capacity is kept when it is recycled.
+    auto vector() -> std::vector<T>& { return block_->data; }
+
+    /// \brief Shares the buffer. The builder can't be used afterwards.
+    auto freeze() && -> Payload<T>;
+
+private:
+    template <typename>
+    friend class PayloadPool;
+
+    explicit PayloadBuilder(std::unique_ptr<detail::PayloadBlock<T>> block) : block_(std::move(block)) {}
+
+    std::unique_ptr<detail::PayloadBlock<T>> block_;
+};
+
+/**
+ * @brief Recycles the storage of Payloads so a steady stream of large buffers stops allocating.
+ *
+ * The pool may be destroyed before the payloads it handed out. Their storage is freed
+ * when they are dropped in that case. At most 'max_free_blocks' idle buffers are kept.
+ */
+template <typename T>
+class PayloadPool {
+public:
+    explicit PayloadPool(std::size_t max_free_blocks = 64u);
+    ~PayloadPool();
+
+    PayloadPool(PayloadPool const&) = delete;
+    auto operator=(PayloadPool const&) -> PayloadPool& = delete;
+
+    /// \brief Storage holding 'size' elements. Recycled elements keep their previous values.
+    auto acquire(std::size_t size) -> PayloadBuilder<T>;
+
+    /// \brief Idle buffers waiting to be reused
+    auto free_count() const -> std::size_t;
+
+    /// \brief Buffers allocated by the pool so far (recycled buffers are not counted again)
+    auto allocated_count() const -> std::size_t;
+
+private:
+    std::shared_ptr<detail::PayloadPoolState<T>> state_;
+};
+
+namespace detail {
+
+template <typename T>
+auto PayloadPoolState<T>::recycle(std::unique_ptr<PayloadBlock<T>> block) -> void {
+    // The block's reference to this state is dropped outside the lock since it may be the last one
+    auto self = std::move(block->pool);
+
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (free_blocks.size() < max_free_blocks) {
+        free_blocks.emplace_back(std::move(block));
+    }
+}
+
+} // namespace detail
+
+template <typename T>
+Payload<T>::Payload(std::vector<T> data) : block_(new detail::PayloadBlock<T>{std::move(data), {1u}, nullptr}) {}
+
+template <typename T>
+auto Payload<T>::operator=(Payload const& other) noexcept -> Payload& {
+    if (block_ != other.block_) {
+        release();
+        block_ = other.block_;
+        retain();
+    }
+    return *this;
+}
+
+template <typename T>
+auto Payload<T>::operator=(Payload&& other) noexcept -> Payload& {
+    if (this != &other) {
+        release();
+        block_ = std::exchange(other.block_, nullptr);
+    }
+    return *this;
+}
+
+template <typename T>
+auto Payload<T>::retain() -> void {
+    if (block_) {
+        block_->refs.fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+auto Payload<T>::release() -> void {
+    if (!block_) {
+        return;
+    }
+
+    auto block = std::exchange(block_, nullptr);
+
+    // Acquire-release so every reader is done with the buffer before it is reused or freed
+    if (block->refs.fetch_sub(1u, std::memory_order_acq_rel) != 1u) {
+        return;
+    }
+
+    auto owned = std::unique_ptr<detail::PayloadBlock<T>>(block);
+    if (auto* pool = owned->pool.get()) {
+        pool->recycle(std::move(owned));
+    }
+}
+
+template <typename T>
+PayloadBuilder<T>::~PayloadBuilder() {
+    if (block_ && block_->pool) {
+        block_->pool->recycle(std::move(block_));
+    }
+}
+
+template <typename T>
+auto PayloadBuilder<T>::operator=(PayloadBuilder&& other) noexcept -> PayloadBuilder& {
+    if (this != &other) {
+        auto previous = std::exchange(block_, std::move(other.block_));
+        if (previous && previous->pool) {
+            previous->pool->recycle(std::move(previous));
+        }
+    }
+    return *this;
+}
+
+template <typename T>
+auto PayloadBuilder<T>::freeze() && -> Payload<T> {
+    if (!block_) {
+        throw std::logic_error("PayloadBuilder was already frozen");
+    }
+    return Payload<T>(block_.release());
+}
+
+template <typename T>
+PayloadPool<T>::PayloadPool(std::size_t max_free_blocks)
+    : state_(std::make_shared<detail::PayloadPoolState<T>>()) {
+    state_->max_free_blocks = max_free_blocks;
+}
+
+template <typename T>
+PayloadPool<T>::~PayloadPool() {
+    // Outstanding blocks keep the state alive but should be freed rather than recycled from now on
+    auto lock               = std::lock_guard<std::mutex>(state_->mutex);
+    state_->max_free_blocks = 0u;
+    state_->free_blocks.clear();
+}
+
+template <typename T>
+auto PayloadPool<T>::acquire(std::size_t size) -> PayloadBuilder<T> {
+    auto block = std::unique_ptr<detail::PayloadBlock<T>>();
+    {
+        auto lock = std::lock_guard<std::mutex>(state_->mutex);
+        if (!state_->free_blocks.empty()) {
+            block = std::move(state_->free_blocks.back());
+            state_->free_blocks.pop_back();
+        } else {
+            ++state_->allocated;
+        }
+    }
+
+    if (!block) {
+        block = std::make_unique<detail::PayloadBlock<T>>();
+    }
+    block->data.resize(size);
+    block->pool = state_;
+    return PayloadBuilder<T>(std::move(block));
+}
+
+template <typename T>
+auto PayloadPool<T>::free_count() const -> std::size_t {
+    auto lock = std::lock_guard<std::mutex>(state_->mutex);
+    return state_->free_blocks.size();
+}
+
+template <typename T>
+auto PayloadPool<T>::allocated_count() const -> std::size_t {
+    auto lock = std::lock_guard<std::mutex>(state_->mutex);
+    return state_->allocated;
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,103 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstdint>
+#include <limits>
+#include <tuple>
+
+namespace ltb::ddf {
+
+using NodeId    = std::uint32_t;
+using PortIndex = std::uint32_t;
+
+constexpr auto invalid_node = std::numeric_limits<NodeId>::max();
+
+/// \brief An untyped reference to an input or output port on a node
+struct PortRef {
+    NodeId    node  = invalid_node;
+    PortIndex index = 0u;
+};
+
+/// \brief A typed handle to a node output. Only used when building a graph.
+template <typename T>
+struct OutputPort {
+    using ValueType = T;
+
+    NodeId    node  = invalid_node;
+    PortIndex index = 0u;
+
+    operator PortRef() const { return {node, index}; } // NOLINT(google-explicit-constructor)
+};
+
+/// \brief A typed handle to a node input. Only used when building a graph.
+template <typename T>
+struct InputPort {
+    using ValueType = T;
+
+    NodeId    node  = invalid_node;
+    PortIndex index = 0u;
+
+    operator PortRef() const { return {node, index}; } // NOLINT(google-explicit-constructor)
+};
+
+/// \brief Tag type used to list the input port types of a node
+template <typename... Ts>
+struct Inputs {};
+
+/// \brief Tag type used to list the output port types of a node
+template <typename... Ts>
+struct Outputs {};
+
+template <typename Ins, typename Outs>
+class Node;
+
+/**
+ * @brief A typed handle to a node that was added to a graph.
+ *
+ *     auto node = graph.add_node("adder", ddf::Inputs<int, int>{}, ddf::Outputs<int>{}, body);
+ *     graph.connect(node.output<0>(), other.input<1>());
+ */
+template <typename... Ins, typename... Outs>
+class Node<Inputs<Ins...>, Outputs<Outs...>> {
+public:
+    explicit Node(NodeId id) : id_(id) {}
+
+    template <PortIndex I>
+    auto input() const -> InputPort<std::tuple_element_t<I, std::tuple<Ins...>>> {
+        return {id_, I};
+    }
+
+    template <PortIndex I>
+    auto output() const -> OutputPort<std::tuple_element_t<I, std::tuple<Outs...>>> {
+        return {id_, I};
+    }
+
+    auto id() const -> NodeId { return id_; }
+
+private:
+    NodeId id_;
+};
+
+} // namespace ltb::ddf
@@ -0,0 +1,425 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "profiler.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+
+namespace ltb::ddf {
+namespace {
+
+constexpr char          dump_magic[4] = {'L', 'D', 'D', 'F'};
+constexpr std::uint32_t dump_version  = 1u;
+
+auto bucket_of(std::uint64_t value) -> std::size_t {
+    auto bucket = std::size_t{0u};
+    while (value != 0u) {
+        value >>= 1u;
+        ++bucket;
+    }
+    return bucket;
+}
+
+template <typename T>
+auto write_value(std::ostream& out, T const& value) -> void {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto read_value(std::istream& in, T* value) -> bool {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(value), sizeof(T)));
+}
+
+/// \brief Reads 'length' characters in small chunks so a corrupt length fails at the end of
+///        the stream instead of allocating the whole string up front
+auto read_string(std::istream& in, std::uint32_t length, std::string* value) -> bool {
+    char chunk[256];
+
+    while (length > 0u) {
+        auto const size = std::min(length, static_cast<std::uint32_t>(sizeof(chunk)));
+        if (!in.read(chunk, size)) {
+            return false;
+        }
+        value->append(chunk, size);
+        length -= size;
+    }
+    return true;
+}
+
+} // namespace
+
+auto Histogram::record(std::uint64_t value) -> void {
+    ++buckets_[bucket_of(value)];
+    min_ = (count_ == 0u) ? value : std::min(min_, value);
+    max_ = std::max(max_, value);
+    total_ += value;
+    ++count_;
+}
+
+auto Histogram::reset() -> void {
+    *this = Histogram{};
+}
+
+auto Histogram::count() const -> std::uint64_t {
+    return count_;
+}
+
+auto Histogram::total() const -> std::uint64_t {
+    return total_;
+}
+
+auto Histogram::min() const -> std::uint64_t {
+    return min_;
+}
+
+auto Histogram::max() const -> std::uint64_t {
+    return max_;
+}
+
+auto Histogram::mean() const -> double {
+    return count_ == 0u ? 0.0 : static_cast<double>(total_) / static_cast<double>(count_);
+}
+
+auto Histogram::percentile(double fraction) const -> std::uint64_t {
+    if (count_ == 0u) {
+        return 0u;
+    }
+
+    auto const target     = static_cast<std::uint64_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count_));
+    auto       cumulative = std::uint64_t{0u};
+
+    for (auto b = 0u; b < bucket_count; ++b) {
+        cumulative += buckets_[b];
+
+        if (cumulative >= std::max(target, std::uint64_t{1u})) {
+            auto const upper = (b >= 64u) ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t{1u} << b) - 1u;
+            return std::clamp(upper, min_, max_);
+        }
+    }
+    return max_;
+}
+
+auto Histogram::buckets() const -> std::array<std::uint64_t, bucket_count> const& {
+    return buckets_;
+}
+
+Profiler::Profiler() {
+    reserve_workers(1u);
+}
+
+auto Profiler::now() -> std::uint64_t {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+auto Profiler::resize(std::size_t node_count) -> void {
+    nodes_.resize(node_count);
+}
+
+auto Profiler::reserve_workers(std::size_t worker_count) -> void {
+    if (trace_.size() < worker_count) {
+        trace_.resize(worker_count);
+        set_trace_capacity(trace_capacity_);
+    }
+}
+
+auto Profiler::set_trace_capacity(std::size_t events_per_worker) -> void {
+    trace_capacity_ = events_per_worker;
+
+    for (auto& ring : trace_) {
+        ring.events.clear();
+        ring.events.reserve(trace_capacity_);
+        ring.next = 0u;
+    }
+}
+
+auto Profiler::record_node(NodeId node, std::size_t worker, std::uint64_t begin_ns, std::uint64_t end_ns) -> void {
+    nodes_[node].execution_ns.record(end_ns - begin_ns);
+
+    if (trace_capacity_ == 0u) {
+        return;
+    }
+
+    auto& ring  = trace_[worker];
+    auto  event = TraceEvent{node, static_cast<std::uint32_t>(worker), begin_ns, end_ns};
+
+    if (ring.events.size() < trace_capacity_) {
+        ring.events.emplace_back(event);
+    } else {
+        ring.events[ring.next] = event;
+        ring.next              = (ring.next + 1u) % trace_capacity_;
+    }
+}
+
+auto Profiler::record_tick(std::uint64_t begin_ns, std::uint64_t end_ns) -> void {
+    ticks_.duration_ns.record(end_ns - begin_ns);
+
+    if (ticks_.duration_ns.count() > 1u) {
+        auto const period = begin_ns - last_tick_begin_;
+        ticks_.period_ns.record(period);
+
+        if (ticks_.period_ns.count() > 1u) {
+            ticks_.jitter_ns.record(period > last_tick_period_ ? period - last_tick_period_
+                                                               : last_tick_period_ - period);
+        }
+        last_tick_period_ = period;
+    }
+    last_tick_begin_ = begin_ns;
+}
+
+auto Profiler::edge(std::string const& name) -> std::size_t {
+    auto iter = std::find_if(edges_.begin(), edges_.end(), [&name](auto const& edge) { return edge.name == name; });
+
+    if (iter != edges_.end()) {
+        return static_cast<std::size_t>(std::distance(edges_.begin(), iter));
+    }
+    edges_.push_back({name, {}, 0u});
+    return edges_.size() - 1u;
+}
+
+auto Profiler::record_queue_depth(std::size_t edge, std::size_t depth, std::uint64_t dropped) -> void {
+    edges_[edge].queue_depth.record(depth);
+    edges_[edge].dropped = dropped;
+}
+
+auto Profiler::reset() -> void {
+    for (auto& node : nodes_) {
+        node = NodeProfile{};
+    }
+    for (auto& edge : edges_) {
+        edge = EdgeProfile{edge.name, {}, 0u};
+    }
+    ticks_            = TickProfile{};
+    last_tick_begin_  = 0u;
+    last_tick_period_ = 0u;
+    set_trace_capacity(trace_capacity_);
+}
+
+auto Profiler::node(NodeId node) const -> NodeProfile const& {
+    return nodes_.at(node);
+}
+
+auto Profiler::nodes() const -> std::vector<NodeProfile> const& {
+    return nodes_;
+}
+
+auto Profiler::edges() const -> std::vector<EdgeProfile> const& {
+    return edges_;
+}
+
+auto Profiler::ticks() const -> TickProfile const& {
+    return ticks_;
+}
+
+auto Profiler::trace() const -> std::vector<TraceEvent> {
+    std::vector<TraceEvent> events;
+
+    for (auto const& ring : trace_) {
+        events.insert(events.end(), ring.events.begin(), ring.events.end());
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.begin_ns < rhs.begin_ns;
+    });
+    return events;
+}
+
+auto Profiler::write_binary(std::ostream& out, std::vector<std::string> const& node_names) const -> void {
+    out.write(dump_magic, sizeof(dump_magic));
+    write_value(out, dump_version);
+    write_value(out, static_cast<std::uint32_t>(nodes_.size()));
+
+    for (auto n = 0u; n < nodes_.size(); ++n) {
+        auto const& name = (n < node_names.size()) ? node_names[n] : std::string{};
+
+        write_value(out, static_cast<std::uint32_t>(name.size()));
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        write_value(out, nodes_[n].execution_ns.count());
+        write_value(out, nodes_[n].execution_ns.total());
+    }
+
+    auto const events = trace();
+    write_value(out, static_cast<std::uint64_t>(events.size()));
+
+    for (auto const& event : events) {
+        write_value(out, event.node);
+        write_value(out, event.worker);
+        write_value(out, event.begin_ns);
+        write_value(out, event.end_ns);
+    }
+}
+
+auto Profiler::read_binary(std::istream& in) -> util::Result<ProfileDump> {
+    char          magic[4] = {};
+    std::uint32_t version  = 0u;
+    std::uint32_t nodes    = 0u;
+
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, dump_magic)) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Not a ddf profile dump"));
+    }
+    if (!read_value(in, &version) || version != dump_version) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Unsupported ddf profile dump version"));
+    }
+    if (!read_value(in, &nodes)) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Truncated ddf profile dump"));
+    }
+
+    // Counts and lengths come from the stream so nothing is sized from them up front
+    ProfileDump dump;
+
+    for (auto n = 0u; n < nodes; ++n) {
+        std::uint32_t length      = 0u;
+        std::string   name        = {};
+        std::uint64_t invocations = 0u;
+        std::uint64_t total_ns    = 0u;
+
+        if (!read_value(in, &length) || !read_string(in, length, &name) || !read_value(in, &invocations)
+            || !read_value(in, &total_ns)) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Truncated ddf profile dump"));
+        }
+        dump.node_names.emplace_back(std::move(name));
+        dump.invocations.emplace_back(invocations);
+        dump.total_ns.emplace_back(total_ns);
+    }
+
+    std::uint64_t event_count = 0u;
+    if (!read_value(in, &event_count)) {
+        return tl::make_unexpected(LTB_MAKE_ERROR("Truncated ddf profile dump"));
+    }
+
+    for (auto e = std::uint64_t{0u}; e < event_count; ++e) {
+        TraceEvent event = {};
+
+        if (!read_value(in, &event.node) || !read_value(in, &event.worker) || !read_value(in, &event.begin_ns)
+            || !read_value(in, &event.end_ns)) {
+            return tl::make_unexpected(LTB_MAKE_ERROR("Truncated ddf profile dump"));
+        }
+        dump.events.emplace_back(event);
+    }
+
+    return dump;
+}
+
+TEST_CASE("[ltb][ddf] histogram percentiles") {
+    Histogram histogram;
+    CHECK(histogram.percentile(0.5) == 0u);
+
+    for (auto i = 1u; i <= 100u; ++i) {
+        histogram.record(i);
+    }
+
+    CHECK(histogram.count() == 100u);
+    CHECK(histogram.min() == 1u);
+    CHECK(histogram.max() == 100u);
+    CHECK(histogram.mean() == doctest::Approx(50.5));
+
+    // 50 falls in the [32, 64) bucket and 99 in [64, 128) which is clamped to the max
+    CHECK(histogram.percentile(0.5) == 63u);
+    CHECK(histogram.percentile(0.99) == 100u);
+    CHECK(histogram.percentile(0.0) == 1u);
+}
+
+TEST_CASE("[ltb][ddf] profiler trace ring and binary dump") {
+    Profiler profiler;
+    profiler.resize(2u);
+    profiler.reserve_workers(2u);
+    profiler.set_trace_capacity(2u);
+
+    profiler.record_node(0u, 0u, 10u, 20u);
+    profiler.record_node(1u, 1u, 15u, 30u);
+    profiler.record_node(0u, 0u, 40u, 45u);
+    profiler.record_node(0u, 0u, 50u, 60u); // Overwrites the oldest event of worker 0
+
+    CHECK(profiler.node(0u).execution_ns.count() == 3u);
+    CHECK(profiler.node(1u).execution_ns.total() == 15u);
+
+    auto const events = profiler.trace();
+    REQUIRE(events.size() == 3u);
+    CHECK(events[0].begin_ns == 15u);
+    CHECK(events[1].begin_ns == 40u);
+    CHECK(events[2].begin_ns == 50u);
+
+    std::stringstream stream;
+    profiler.write_binary(stream, {"source", "sink"});
+
+    auto dump = Profiler::read_binary(stream);
+    REQUIRE(dump);
+    CHECK(dump->node_names == std::vector<std::string>{"source", "sink"});
+    CHECK(dump->invocations == std::vector<std::uint64_t>{3u, 1u});
+    CHECK(dump->total_ns == std::vector<std::uint64_t>{25u, 15u});
+    REQUIRE(dump->events.size() == 3u);
+    CHECK(dump->events[2].end_ns == 60u);
+
+    std::stringstream garbage("not a dump");
+    CHECK_FALSE(Profiler::read_binary(garbage));
+}
+
+TEST_CASE("[ltb][ddf] profiler rejects corrupt dump sizes") {
+    Profiler profiler;
+    profiler.resize(1u);
+    profiler.record_node(0u, 0u, 10u, 20u);
+
+    std::stringstream stream;
+    profiler.write_binary(stream, {"node"});
+    auto const valid = stream.str();
+
+    auto const corrupt = [&valid](std::size_t offset) {
+        auto bytes = valid;
+        std::fill_n(bytes.begin() + static_cast<std::ptrdiff_t>(offset), sizeof(std::uint32_t), '\xff');
+        return std::stringstream(bytes);
+    };
+
+    // The node count follows the magic and version, then the first name length
+    auto huge_node_count = corrupt(8u);
+    CHECK_FALSE(Profiler::read_binary(huge_node_count));
+
+    auto huge_name_length = corrupt(12u);
+    CHECK_FALSE(Profiler::read_binary(huge_name_length));
+
+    // Truncated part way through the events
+    std::stringstream truncated(valid.substr(0u, valid.size() - 4u));
+    CHECK_FALSE(Profiler::read_binary(truncated));
+}
+
+TEST_CASE("[ltb][ddf] profiler tick jitter") {
+    Profiler profiler;
+
+    profiler.record_tick(0u, 2u);
+    profiler.record_tick(10u, 12u);
+    profiler.record_tick(20u, 25u);
+    profiler.record_tick(35u, 36u);
+
+    CHECK(profiler.ticks().duration_ns.count() == 4u);
+    CHECK(profiler.ticks().period_ns.count() == 3u);
+    CHECK(profiler.ticks().jitter_ns.count() == 2u);
+    CHECK(profiler.ticks().jitter_ns.max() == 5u);
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,184 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ports.hpp"
+#include "ltb/util/result.hpp"
+
+// standard
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ltb::ddf {
+
+/// \brief Profiling hooks are only compiled in when LTB_DDF_ENABLE_PROFILING is defined
+#ifdef LTB_DDF_ENABLE_PROFILING
+constexpr bool profiling_enabled = true;
+#else
+constexpr bool profiling_enabled = false;
+#endif
+
+/**
+ * @brief A fixed-size histogram with power-of-two buckets.
+ *
+ * Bucket 'b' holds values in [2^(b-1), 2^b) (bucket 0 only holds 0), so recording is a
+ * bit scan and an increment and the histogram never allocates.
+ */
+class Histogram {
+public:
+    static constexpr std::size_t bucket_count = 65u;
+
+    auto record(std::uint64_t value) -> void;
+    auto reset() -> void;
+
+    auto count() const -> std::uint64_t;
+    auto total() const -> std::uint64_t;
+    auto min() const -> std::uint64_t;
+    auto max() const -> std::uint64_t;
+    auto mean() const -> double;
+
+    /// \brief An upper bound on the value below which 'fraction' (0 to 1) of the samples fall
+    auto percentile(double fraction) const -> std::uint64_t;
+
+    auto buckets() const -> std::array<std::uint64_t, bucket_count> const&;
+
+private:
+    std::array<std::uint64_t, bucket_count> buckets_ = {};
+    std::uint64_t                           count_   = 0u;
+    std::uint64_t                           total_   = 0u;
+    std::uint64_t                           min_     = 0u;
+    std::uint64_t                           max_     = 0u;
+};
+
+/// \brief Timing for a single node. The invocation count is 'execution_ns.count()'.
+struct NodeProfile {
+    Histogram execution_ns;
+};
+
+/// \brief Queue statistics for a cross-region edge, sampled each time the consumer drains it
+struct EdgeProfile {
+    std::string   name;
+    Histogram     queue_depth;
+    std::uint64_t dropped = 0u; ///< Events the producer could not push because the queue was full
+};
+
+/// \brief Timing for every tick of a graph (one graph per region)
+struct TickProfile {
+    Histogram duration_ns; ///< Time spent executing each tick
+    Histogram period_ns; ///< Time between the starts of consecutive ticks
+    Histogram jitter_ns; ///< Difference between consecutive periods
+};
+
+/// \brief A single node execution in the trace
+struct TraceEvent {
+    NodeId        node;
+    std::uint32_t worker; ///< The executor worker that ran the node (0 for serial ticks)
+    std::uint64_t begin_ns; ///< See 'Profiler::now'
+    std::uint64_t end_ns;
+};
+
+/// \brief The contents of a binary profile dump
+struct ProfileDump {
+    std::vector<std::string>   node_names;
+    std::vector<std::uint64_t> invocations; ///< Indexed by NodeId
+    std::vector<std::uint64_t> total_ns; ///< Indexed by NodeId
+    std::vector<TraceEvent>    events; ///< Sorted by begin time
+};
+
+/**
+ * @brief Collects execution statistics for a ddf graph.
+ *
+ * Enabled per graph with 'ddf::enable_profiling'. Every node execution is timed into a
+ * per-node histogram and, if a trace capacity is set, appended to a per-worker ring of
+ * trace events holding the most recent executions. Workers only ever write their own
+ * trace ring and each node runs once per tick, so recording needs no synchronization.
+ *
+ * Statistics should be queried between ticks from the thread that ticks the graph.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Profiler();
+
+    /// \brief Nanoseconds on the steady clock. Every profiler shares the same time base so
+    ///        traces from graphs ticked on different threads line up.
+    static auto now() -> std::uint64_t;
+
+    auto resize(std::size_t node_count) -> void;
+    auto reserve_workers(std::size_t worker_count) -> void;
+
+    /// \brief Keep the last 'events_per_worker' node executions of each worker. 0 disables tracing.
+    auto set_trace_capacity(std::size_t events_per_worker) -> void;
+
+    auto record_node(NodeId node, std::size_t worker, std::uint64_t begin_ns, std::uint64_t end_ns) -> void;
+    auto record_tick(std::uint64_t begin_ns, std::uint64_t end_ns) -> void;
+
+    /// \brief Finds or adds the profile for the edge called 'name'
+    auto edge(std::string const& name) -> std::size_t;
+    auto record_queue_depth(std::size_t edge, std::size_t depth, std::uint64_t dropped) -> void;
+
+    /// \brief Clears every statistic and trace event
+    auto reset() -> void;
+
+    auto node(NodeId node) const -> NodeProfile const&;
+    auto nodes() const -> std::vector<NodeProfile> const&;
+    auto edges() const -> std::vector<EdgeProfile> const&;
+    auto ticks() const -> TickProfile const&;
+
+    /// \brief The recorded trace events from every worker sorted by begin time
+    auto trace() const -> std::vector<TraceEvent>;
+
+    /**
+     * @brief Writes the per-node totals and trace as a compact binary dump.
+     *
+     * Layout (native byte order): "LDDF", u32 version, u32 node count, then per node a u32
+     * name length, the name, u64 invocations and u64 total ns, then a u64 event count
+     * followed by { u32 node, u32 worker, u64 begin ns, u64 end ns } per event.
+     */
+    auto write_binary(std::ostream& out, std::vector<std::string> const& node_names) const -> void;
+
+    static auto read_binary(std::istream& in) -> util::Result<ProfileDump>;
+
+private:
+    struct TraceRing {
+        std::vector<TraceEvent> events;
+        std::size_t             next = 0u; ///< Where the next event is written once the ring is full
+    };
+
+    std::vector<NodeProfile> nodes_;
+    std::vector<EdgeProfile> edges_;
+    TickProfile              ticks_;
+    std::vector<TraceRing>   trace_; ///< One ring per worker
+    std::size_t              trace_capacity_   = 0u;
+    std::uint64_t            last_tick_begin_  = 0u;
+    std::uint64_t            last_tick_period_ = 0u;
+};
+
+} // namespace ltb::ddf
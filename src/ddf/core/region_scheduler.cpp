@@ -0,0 +1,473 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "region_scheduler.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ltb::ddf {
+namespace {
+
+auto pin_current_thread(int cpu) -> bool {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+} // namespace
+
+struct RegionScheduler::Region {
+    std::string       name;
+    ddf*              graph;
+    RegionOptions     options;
+    Clock::time_point next_release; ///< When the next tick may start. Its deadline is one period later.
+    bool              running = false; ///< True while a worker is ticking the region
+    bool              failed  = false; ///< Set when a tick throws
+
+    std::atomic<std::uint64_t> ticks{0u};
+    std::atomic<std::uint64_t> overruns{0u};
+    std::atomic<std::uint64_t> skipped{0u};
+    std::atomic<std::uint64_t> max_lateness_ns{0u};
+};
+
+RegionScheduler::RegionScheduler(std::size_t worker_count, std::vector<int> cpus)
+    : worker_count_(worker_count == 0u ? std::max(1u, std::thread::hardware_concurrency()) : worker_count),
+      cpus_(std::move(cpus)) {}
+
+RegionScheduler::~RegionScheduler() {
+    try {
+        stop();
+    } catch (...) {
+        // Exceptions from ticks are only reported by an explicit 'stop'
+    }
+}
+
+auto RegionScheduler::add_region(std::string name, ddf& graph, RegionOptions options) -> RegionId {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (running_) {
+        throw std::runtime_error("Regions cannot be added while the scheduler is running");
+    }
+    if (options.period <= std::chrono::nanoseconds::zero()) {
+        throw std::invalid_argument("Region '" + name + "' must have a positive period");
+    }
+
+    auto region     = std::make_unique<Region>();
+    region->name    = std::move(name);
+    region->graph   = &graph;
+    region->options = options;
+    regions_.emplace_back(std::move(region));
+
+    return static_cast<RegionId>(regions_.size() - 1u);
+}
+
+auto RegionScheduler::start() -> void {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+
+        auto const now = Clock::now();
+        for (auto& region : regions_) {
+            region->next_release = now;
+            region->failed       = false;
+        }
+    }
+
+    for (auto i = 0u; i < worker_count_; ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+auto RegionScheduler::stop() -> void {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_  = false;
+        stopping_ = false;
+        error     = std::exchange(error_, nullptr);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+auto RegionScheduler::is_running() const -> bool {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+auto RegionScheduler::worker_count() const -> std::size_t {
+    return worker_count_;
+}
+
+auto RegionScheduler::region_count() const -> std::size_t {
+    return regions_.size();
+}
+
+auto RegionScheduler::region_name(RegionId region) const -> std::string const& {
+    return regions_.at(region)->name;
+}
+
+auto RegionScheduler::stats(RegionId region) const -> RegionStats {
+    auto const& r = *regions_.at(region);
+    return {
+        r.ticks.load(std::memory_order_relaxed),
+        r.overruns.load(std::memory_order_relaxed),
+        r.skipped.load(std::memory_order_relaxed),
+        r.max_lateness_ns.load(std::memory_order_relaxed),
+    };
+}
+
+auto RegionScheduler::pinned_workers() const -> std::size_t {
+    return pinned_workers_.load();
+}
+
+auto RegionScheduler::worker_loop(std::size_t worker) -> void {
+    if (!cpus_.empty() && pin_current_thread(cpus_[worker % cpus_.size()])) {
+        ++pinned_workers_;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopping_) {
+        auto const now = Clock::now();
+
+        // Earliest deadline first among the released regions
+        Region* next          = nullptr;
+        auto    next_deadline = Clock::time_point::max();
+        auto    next_release  = Clock::time_point::max();
+
+        for (auto& region : regions_) {
+            if (region->running || region->failed) {
+                continue;
+            }
+
+            if (region->next_release <= now) {
+                auto const deadline = region->next_release + region->options.period;
+                if (deadline < next_deadline) {
+                    next          = region.get();
+                    next_deadline = deadline;
+                }
+            } else {
+                next_release = std::min(next_release, region->next_release);
+            }
+        }
+
+        if (!next) {
+            if (next_release == Clock::time_point::max()) {
+                condition_.wait(lock);
+            } else {
+                condition_.wait_until(lock, next_release);
+            }
+            continue;
+        }
+
+        next->running = true;
+        lock.unlock();
+
+        auto failed = false;
+        try {
+            next->graph->tick();
+
+            if (next->options.after_tick) {
+                next->options.after_tick(*next->graph);
+            }
+        } catch (...) {
+            failed = true;
+
+            lock.lock();
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+            lock.unlock();
+        }
+
+        auto const finished = Clock::now();
+
+        lock.lock();
+        next->failed = failed;
+        finish_tick(*next, finished);
+        next->running = false;
+
+        // Another worker may be waiting for this region to become available again
+        condition_.notify_all();
+    }
+}
+
+auto RegionScheduler::finish_tick(Region& region, Clock::time_point finished) -> void {
+    auto const period   = region.options.period;
+    auto const deadline = region.next_release + period;
+
+    region.ticks.fetch_add(1u, std::memory_order_relaxed);
+    region.next_release = deadline;
+
+    if (finished <= deadline) {
+        return;
+    }
+
+    auto const lateness = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(finished - deadline).count());
+
+    region.overruns.fetch_add(1u, std::memory_order_relaxed);
+    region.max_lateness_ns.store(std::max(region.max_lateness_ns.load(std::memory_order_relaxed), lateness),
+                                 std::memory_order_relaxed);
+
+    // Every release up to and including 'finished' has been missed
+    auto missed = static_cast<std::uint64_t>((finished - deadline) / period) + 1u;
+
+    if (region.options.overrun_policy == OverrunPolicy::CatchUp) {
+        // The oldest missed releases are dropped so at most 'max_catch_up' run back to back
+        auto const dropped = missed > region.options.max_catch_up ? missed - region.options.max_catch_up : 0u;
+        region.next_release += period * dropped;
+        region.skipped.fetch_add(dropped, std::memory_order_relaxed);
+    } else {
+        region.next_release += period * missed;
+        region.skipped.fetch_add(missed, std::memory_order_relaxed);
+    }
+}
+
+TEST_CASE("[ltb][ddf] region scheduler ticks regions at their periods") {
+    ddf fast;
+    ddf slow;
+
+    auto fast_count = std::atomic<int>{0};
+    auto slow_count = std::atomic<int>{0};
+
+    fast.add_source("count", [&fast_count] { return ++fast_count; });
+    slow.add_source("count", [&slow_count] { return ++slow_count; });
+    REQUIRE(fast.compile());
+    REQUIRE(slow.compile());
+
+    // Pin to a CPU this process is actually allowed to run on
+    auto cpus = std::vector<int>{};
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    REQUIRE(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    for (auto cpu = 0; cpu < CPU_SETSIZE && cpus.empty(); ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.emplace_back(cpu);
+        }
+    }
+    REQUIRE_FALSE(cpus.empty());
+#endif
+
+    constexpr auto fast_period = std::chrono::milliseconds(2);
+    constexpr auto slow_period = std::chrono::milliseconds(20);
+
+    RegionScheduler scheduler(2u, cpus);
+    auto const      fast_id = scheduler.add_region("fast", fast, {fast_period});
+    auto const      slow_id = scheduler.add_region("slow", slow, {slow_period});
+
+    CHECK_THROWS(scheduler.add_region("invalid", slow, {std::chrono::milliseconds(0)}));
+
+    auto const started = RegionScheduler::Clock::now();
+    scheduler.start();
+    CHECK(scheduler.is_running());
+    CHECK_THROWS(scheduler.add_region("late", slow, {std::chrono::milliseconds(1)}));
+
+    // Wait for progress rather than a fixed time so a loaded machine only makes the test slower
+    auto const timeout = started + std::chrono::seconds(10);
+    while (scheduler.stats(slow_id).ticks < 3u && RegionScheduler::Clock::now() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.stop();
+    auto const elapsed = RegionScheduler::Clock::now() - started;
+    CHECK_FALSE(scheduler.is_running());
+
+    auto const fast_stats = scheduler.stats(fast_id);
+    auto const slow_stats = scheduler.stats(slow_id);
+
+    CHECK(fast_stats.ticks == static_cast<std::uint64_t>(fast_count.load()));
+    CHECK(slow_stats.ticks == static_cast<std::uint64_t>(slow_count.load()));
+    CHECK(slow_stats.ticks >= 3u);
+
+    // Every tick or skip consumes one release, and releases never come faster than the period
+    auto const max_releases = [&elapsed](auto period) {
+        return static_cast<std::uint64_t>(elapsed / period) + 1u;
+    };
+    CHECK(fast_stats.ticks + fast_stats.skipped <= max_releases(fast_period));
+    CHECK(slow_stats.ticks + slow_stats.skipped <= max_releases(slow_period));
+    CHECK(fast_stats.overruns <= fast_stats.ticks);
+    CHECK(slow_stats.overruns <= slow_stats.ticks);
+
+    CHECK(scheduler.region_name(slow_id) == "slow");
+
+#ifdef __linux__
+    CHECK(scheduler.pinned_workers() == 2u);
+#endif
+}
+
+TEST_CASE("[ltb][ddf] region scheduler ticks the earliest deadline first") {
+    auto order = std::vector<char>{};
+
+    ddf fast;
+    ddf slow;
+    fast.add_source("record", [&order] {
+        order.emplace_back('f');
+        return 0;
+    });
+    slow.add_source("record", [&order] {
+        order.emplace_back('s');
+        return 0;
+    });
+    REQUIRE(fast.compile());
+    REQUIRE(slow.compile());
+
+    // One worker so the ticks are serialized. The slow region is added first so insertion
+    // order cannot explain the result.
+    RegionScheduler scheduler(1u);
+    auto const      slow_id = scheduler.add_region("slow", slow, {std::chrono::seconds(10)});
+    scheduler.add_region("fast", fast, {std::chrono::milliseconds(1)});
+
+    scheduler.start();
+    auto const timeout = RegionScheduler::Clock::now() + std::chrono::seconds(10);
+    while (scheduler.stats(slow_id).ticks == 0u && RegionScheduler::Clock::now() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.stop();
+
+    // Both regions are released together at start, so the one with the earlier deadline runs first
+    REQUIRE(order.size() >= 2u);
+    CHECK(order.front() == 'f');
+}
+
+TEST_CASE("[ltb][ddf] region scheduler overrun policies") {
+    ddf graph;
+    graph.add_source("slow", [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return 0;
+    });
+    REQUIRE(graph.compile());
+
+    auto options = RegionOptions{std::chrono::milliseconds(2)};
+
+    SUBCASE("skip") { options.overrun_policy = OverrunPolicy::Skip; }
+    SUBCASE("catch up") {
+        options.overrun_policy = OverrunPolicy::CatchUp;
+        options.max_catch_up   = 1u;
+    }
+
+    RegionScheduler scheduler(1u);
+    auto const      region = scheduler.add_region("slow", graph, options);
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.stop();
+
+    auto const stats = scheduler.stats(region);
+    CHECK(stats.ticks > 0u);
+    CHECK(stats.overruns == stats.ticks);
+    CHECK(stats.skipped > 0u);
+    CHECK(stats.max_lateness_ns >= 2'000'000u);
+}
+
+TEST_CASE("[ltb][ddf] region scheduler rethrows tick exceptions on stop") {
+    ddf graph;
+    graph.add_source("throws", []() -> int { throw std::runtime_error("tick failed"); });
+    REQUIRE(graph.compile());
+
+    RegionScheduler scheduler(1u);
+    auto const      region = scheduler.add_region("throws", graph, {std::chrono::milliseconds(1)});
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK_THROWS_AS(scheduler.stop(), std::runtime_error);
+
+    // The failing region is not ticked again after it throws
+    CHECK(scheduler.stats(region).ticks == 1u);
+}
+
+TEST_CASE("[ltb][ddf] region scheduler keeps running while a graph is hot swapped") {
+    auto latest = std::atomic<int>{0};
+
+    auto make_graph = [&latest](int value) -> util::Result<ddf> {
+        ddf  graph;
+        auto source = graph.add_source("source", [value] { return value; });
+        auto sink   = graph.add_node("sink", Inputs<int>{}, Outputs<>{}, [&latest](NodeContext& ctx) {
+            latest = ctx.input<int>(0);
+        });
+        if (auto connected = graph.connect(source, sink.input<0>()); !connected) {
+            return tl::make_unexpected(connected.error());
+        }
+        return graph;
+    };
+
+    auto initial = make_graph(1);
+    REQUIRE(initial);
+    ddf graph = std::move(initial.value());
+    REQUIRE(graph.compile());
+
+    RegionScheduler scheduler;
+    auto const      id = scheduler.add_region("swapped", graph, {std::chrono::milliseconds(1)});
+    scheduler.start();
+
+    auto result = graph.stage([&make_graph] { return make_graph(2); });
+    REQUIRE(result.get());
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (graph.swap_count() == 0u && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    scheduler.stop();
+    CHECK(graph.swap_count() == 1u);
+    CHECK(latest == 2);
+    CHECK(scheduler.stats(id).ticks > 0u);
+}
+
+} // namespace ltb::ddf
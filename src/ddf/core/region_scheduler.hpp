@@ -0,0 +1,139 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf.hpp"
+
+// standard
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ltb::ddf {
+
+using RegionId = std::uint32_t;
+
+/// \brief What a region does when a tick finishes after the next tick should have started
+enum class OverrunPolicy {
+    Skip, ///< Drop the missed ticks and resume on the next period boundary
+    CatchUp, ///< Run the missed ticks back to back (up to 'RegionOptions::max_catch_up' of them)
+};
+
+struct RegionOptions {
+    std::chrono::nanoseconds period; ///< Time between tick releases. Each tick's deadline is its next release.
+    OverrunPolicy            overrun_policy = OverrunPolicy::Skip;
+    std::uint32_t            max_catch_up   = 4u; ///< Missed ticks beyond this are skipped even when catching up
+
+    /// \brief Called on the worker right after each successful tick, e.g. to sample metrics
+    std::function<void(ddf&)> after_tick = nullptr;
+};
+
+/// \brief Counters for a scheduled region. Safe to read while the scheduler is running.
+struct RegionStats {
+    std::uint64_t ticks; ///< Ticks executed
+    std::uint64_t overruns; ///< Ticks that finished after their deadline
+    std::uint64_t skipped; ///< Releases dropped because the region was running late
+    std::uint64_t max_lateness_ns; ///< The furthest past its deadline a tick has finished
+};
+
+/**
+ * @brief Ticks ddf regions periodically on a shared pool of worker threads.
+ *
+ * Each region is a ddf graph with its own period. A tick is released at the start of each
+ * period and must finish before the next release (its deadline). Idle workers always pick
+ * the released region with the earliest deadline, so short-period regions keep their
+ * rate when the pool is oversubscribed. A region never ticks on two workers at once.
+ *
+ * A tick finishing after its deadline counts as an overrun and the region's
+ * 'OverrunPolicy' decides whether the missed releases are skipped or caught up.
+ *
+ *     ltb::ddf::RegionScheduler scheduler(2);
+ *     scheduler.add_region("control", control_graph, {std::chrono::milliseconds(1)});
+ *     scheduler.add_region("planning", planning_graph, {std::chrono::milliseconds(50)});
+ *     scheduler.start();
+ *
+ * Graphs must be compiled before they are added and must not be modified while the
+ * scheduler is running.
+ */
+class RegionScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// \brief Zero workers uses every hardware thread. If 'cpus' is not empty, worker 'i' is
+    ///        pinned to 'cpus[i % cpus.size()]' where the platform supports it.
+    explicit RegionScheduler(std::size_t worker_count = 0u, std::vector<int> cpus = {});
+    ~RegionScheduler();
+
+    RegionScheduler(RegionScheduler const&) = delete;
+    RegionScheduler(RegionScheduler&&)      = delete;
+    auto operator=(RegionScheduler const&) -> RegionScheduler& = delete;
+    auto operator=(RegionScheduler&&) -> RegionScheduler& = delete;
+
+    /// \brief Adds a region. 'graph' must outlive the scheduler. Only allowed while stopped.
+    auto add_region(std::string name, ddf& graph, RegionOptions options) -> RegionId;
+
+    /// \brief Starts the workers. The first tick of every region is released immediately.
+    auto start() -> void;
+
+    /// \brief Waits for running ticks to finish and stops the workers. Rethrows the first
+    ///        exception thrown by a tick (the region that threw is not ticked again).
+    auto stop() -> void;
+
+    auto is_running() const -> bool;
+    auto worker_count() const -> std::size_t;
+    auto region_count() const -> std::size_t;
+    auto region_name(RegionId region) const -> std::string const&;
+    auto stats(RegionId region) const -> RegionStats;
+
+    /// \brief The number of workers that were successfully pinned to a CPU
+    auto pinned_workers() const -> std::size_t;
+
+private:
+    struct Region;
+
+    auto worker_loop(std::size_t worker) -> void;
+    auto finish_tick(Region& region, Clock::time_point finished) -> void;
+
+    std::size_t                          worker_count_;
+    std::vector<int>                     cpus_;
+    std::vector<std::unique_ptr<Region>> regions_;
+    std::vector<std::thread>             threads_;
+    std::atomic<std::size_t>             pinned_workers_{0u};
+
+    mutable std::mutex      mutex_;
+    std::condition_variable condition_; ///< Signals workers when a region finishes or the scheduler stops
+    bool                    running_  = false;
+    bool                    stopping_ = false;
+    std::exception_ptr      error_; ///< The first exception thrown by a tick
+};
+
+} // namespace ltb::ddf
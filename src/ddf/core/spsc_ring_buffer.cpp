@@ -0,0 +1,86 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "spsc_ring_buffer.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <thread>
+#include <vector>
+
+TEST_CASE("[ltb][ddf] spsc ring buffer") {
+    using namespace ltb;
+
+    ddf::SpscRingBuffer<int> queue(3u);
+    CHECK(queue.capacity() == 4u);
+
+    auto value = 0;
+    CHECK_FALSE(queue.try_pop(&value));
+
+    CHECK(queue.try_push(1));
+    CHECK(queue.try_push(2));
+    CHECK(queue.try_push(3));
+    CHECK(queue.try_push(4));
+    CHECK_FALSE(queue.try_push(5));
+    CHECK(queue.size() == 4u);
+    CHECK(queue.dropped() == 1u);
+
+    CHECK(queue.try_pop(&value));
+    CHECK(value == 1);
+    CHECK(queue.try_push(6));
+
+    std::vector<int> values;
+    CHECK(queue.consume_all([&](int&& v) { values.push_back(v); }) == 4u);
+    CHECK(values == std::vector<int>{2, 3, 4, 6});
+    CHECK(queue.size() == 0u);
+}
+
+TEST_CASE("[ltb][ddf] spsc ring buffer across threads") {
+    using namespace ltb;
+
+    constexpr auto count = 100000;
+
+    ddf::SpscRingBuffer<int> queue(64u);
+
+    std::thread producer([&] {
+        for (auto i = 0; i < count; ++i) {
+            while (!queue.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // Values must arrive exactly once and in order
+    auto expected = 0;
+    auto in_order = true;
+    while (expected < count) {
+        auto value = 0;
+        if (queue.try_pop(&value)) {
+            in_order &= (value == expected++);
+        }
+    }
+    producer.join();
+
+    CHECK(in_order);
+}
@@ -0,0 +1,170 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ltb::ddf {
+
+/// \brief Used to keep data written by different threads on separate cache lines
+constexpr auto cache_line_size = std::size_t{64u};
+
+/**
+ * @brief A bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * All storage is allocated up front so pushing and popping never allocate or take a lock.
+ * The capacity is rounded up to a power of two.
+ *
+ *     ltb::ddf::SpscRingBuffer<int> queue(1024);
+ *
+ *     // producer thread
+ *     if (!queue.try_push(42)) { ...queue is full... }
+ *
+ *     // consumer thread
+ *     int value;
+ *     while (queue.try_pop(&value)) { ... }
+ */
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(std::size_t capacity);
+
+    /// \brief Producer only. Returns false (and counts 'value' as dropped) if the queue is full.
+    template <typename U>
+    auto try_push(U&& value) -> bool;
+
+    /// \brief Consumer only. Returns false if the queue is empty.
+    auto try_pop(T* value) -> bool;
+
+    /// \brief Consumer only. Calls 'func(T&&)' on every queued value and returns the count.
+    template <typename Func>
+    auto consume_all(Func&& func) -> std::size_t;
+
+    /// \brief An estimate of the number of queued values (exact when called from either end)
+    auto size() const -> std::size_t;
+
+    auto capacity() const -> std::size_t;
+
+    /// \brief The number of values rejected by 'try_push' because the queue was full
+    auto dropped() const -> std::size_t;
+
+private:
+    std::size_t          mask_; ///< capacity - 1
+    std::unique_ptr<T[]> storage_;
+
+    alignas(cache_line_size) std::atomic<std::size_t> head_{0u}; ///< Next index to pop (written by the consumer)
+    alignas(cache_line_size) std::size_t cached_tail_ = 0u; ///< The consumer's last view of 'tail_'
+
+    alignas(cache_line_size) std::atomic<std::size_t> tail_{0u}; ///< Next index to push (written by the producer)
+    alignas(cache_line_size) std::size_t cached_head_ = 0u; ///< The producer's last view of 'head_'
+    std::atomic<std::size_t> dropped_{0u}; ///< Only written by the producer
+};
+
+namespace detail {
+
+inline auto next_power_of_two(std::size_t value) -> std::size_t {
+    auto result = std::size_t{1u};
+    while (result < value) {
+        result <<= 1u;
+    }
+    return result;
+}
+
+} // namespace detail
+
+template <typename T>
+SpscRingBuffer<T>::SpscRingBuffer(std::size_t capacity)
+    : mask_(detail::next_power_of_two(std::max(capacity, std::size_t{1u})) - 1u),
+      storage_(std::make_unique<T[]>(mask_ + 1u)) {}
+
+template <typename T>
+template <typename U>
+auto SpscRingBuffer<T>::try_push(U&& value) -> bool {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+
+    if (tail - cached_head_ > mask_) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+
+        if (tail - cached_head_ > mask_) {
+            dropped_.fetch_add(1u, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    storage_[tail & mask_] = std::forward<U>(value);
+    tail_.store(tail + 1u, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+auto SpscRingBuffer<T>::try_pop(T* value) -> bool {
+    auto const head = head_.load(std::memory_order_relaxed);
+
+    if (head == cached_tail_) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+
+        if (head == cached_tail_) {
+            return false;
+        }
+    }
+
+    *value = std::move(storage_[head & mask_]);
+    head_.store(head + 1u, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+template <typename Func>
+auto SpscRingBuffer<T>::consume_all(Func&& func) -> std::size_t {
+    auto const head = head_.load(std::memory_order_relaxed);
+    cached_tail_    = tail_.load(std::memory_order_acquire);
+
+    for (auto i = head; i != cached_tail_; ++i) {
+        func(std::move(storage_[i & mask_]));
+    }
+
+    head_.store(cached_tail_, std::memory_order_release);
+    return cached_tail_ - head;
+}
+
+template <typename T>
+auto SpscRingBuffer<T>::size() const -> std::size_t {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+auto SpscRingBuffer<T>::capacity() const -> std::size_t {
+    return mask_ + 1u;
+}
+
+template <typename T>
+auto SpscRingBuffer<T>::dropped() const -> std::size_t {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+} // namespace ltb::ddf
@@ -0,0 +1,73 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "static_graph.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <string>
+#include <vector>
+
+namespace ltb::ddf {
+
+TEST_CASE("[ltb][ddf] static pipeline") {
+    auto printed = std::vector<std::string>{};
+
+    auto pipeline = make_static_pipeline([i = 0]() mutable { return ++i; },
+                                         [](int x) { return x * 10; },
+                                         [](int x) { return std::to_string(x); },
+                                         [&printed](std::string const& s) { printed.push_back(s); });
+
+    pipeline.tick();
+    pipeline.tick();
+
+    CHECK(pipeline.value<0>() == 2);
+    CHECK(pipeline.value<1>() == 20);
+    CHECK(pipeline.value<2>() == "20");
+    CHECK(printed == std::vector<std::string>{"10", "20"});
+}
+
+TEST_CASE("[ltb][ddf] static graph with fan-out and fan-in") {
+    struct Sensor {
+        float reading = 1.f;
+        auto  operator()() -> float { return reading; }
+    };
+
+    auto graph = make_static_graph<StaticEdges<StaticEdge<0, 2, 1>, // b - a
+                                               StaticEdge<1, 2, 0>,
+                                               StaticEdge<0, 3, 0>, // a + (b - a)
+                                               StaticEdge<2, 3, 1>>>(
+        Sensor{}, Sensor{}, [](float x, float y) { return x - y; }, [](float x, float y) { return x + y; });
+
+    graph.node<0>().reading = 2.f;
+    graph.node<1>().reading = 5.f;
+    graph.tick();
+
+    CHECK(graph.value<2>() == 3.f);
+    CHECK(graph.value<3>() == 5.f);
+
+    static_assert(std::is_same_v<std::decay_t<decltype(graph.value<3>())>, float>);
+}
+
+} // namespace ltb::ddf
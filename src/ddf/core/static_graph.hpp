@@ -0,0 +1,209 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ltb::ddf {
+
+/// \brief A connection from the output of node 'From' to input 'Input' of node 'To' in a StaticGraph
+template <std::size_t From, std::size_t To, std::size_t Input = 0u>
+struct StaticEdge {
+    static constexpr auto from  = From;
+    static constexpr auto to    = To;
+    static constexpr auto input = Input;
+};
+
+/// \brief The compile-time list of connections in a StaticGraph
+template <typename... Edges>
+struct StaticEdges {};
+
+/// \brief Stored in place of the output of nodes that return void
+struct NoOutput {};
+
+namespace detail {
+
+constexpr auto no_source        = std::numeric_limits<std::size_t>::max();
+constexpr auto multiple_sources = no_source - 1u;
+
+/// \brief One past the highest input index connected on node 'To', so a skipped or repeated
+///        input is reported by the checks on each input rather than miscounted
+template <std::size_t To, typename... Edges>
+constexpr auto static_input_count() -> std::size_t {
+    constexpr std::array<std::size_t, sizeof...(Edges)> tos    = {Edges::to...};
+    constexpr std::array<std::size_t, sizeof...(Edges)> inputs = {Edges::input...};
+
+    auto count = std::size_t{0u};
+    for (auto i = 0u; i < tos.size(); ++i) {
+        if (tos[i] == To) {
+            count = std::max(count, inputs[i] + 1u);
+        }
+    }
+    return count;
+}
+
+template <std::size_t To, std::size_t Input, typename... Edges>
+constexpr auto static_source_of() -> std::size_t {
+    constexpr std::array<std::size_t, sizeof...(Edges)> froms  = {Edges::from...};
+    constexpr std::array<std::size_t, sizeof...(Edges)> tos    = {Edges::to...};
+    constexpr std::array<std::size_t, sizeof...(Edges)> inputs = {Edges::input...};
+
+    auto source = no_source;
+    for (auto i = 0u; i < froms.size(); ++i) {
+        if (tos[i] == To && inputs[i] == Input) {
+            source = (source == no_source ? froms[i] : multiple_sources);
+        }
+    }
+    return source;
+}
+
+template <typename Result>
+using stored_output_t = std::conditional_t<std::is_void_v<Result>, NoOutput, std::decay_t<Result>>;
+
+template <typename Nodes, typename Edges, std::size_t I, typename InputIndices>
+struct StaticNodeTraitsImpl;
+
+template <typename Nodes, typename Edges, std::size_t I>
+struct StaticNodeTraits;
+
+template <typename... Nodes, typename... Edges, std::size_t I>
+struct StaticNodeTraits<std::tuple<Nodes...>, StaticEdges<Edges...>, I>
+    : StaticNodeTraitsImpl<std::tuple<Nodes...>,
+                           StaticEdges<Edges...>,
+                           I,
+                           std::make_index_sequence<static_input_count<I, Edges...>()>> {};
+
+template <typename... Nodes, typename... Edges, std::size_t I, std::size_t... Ks>
+struct StaticNodeTraitsImpl<std::tuple<Nodes...>, StaticEdges<Edges...>, I, std::index_sequence<Ks...>> {
+    static_assert(((static_source_of<I, Ks, Edges...>() != no_source) && ...),
+                  "Every input must be connected to an output (inputs are numbered from 0)");
+    static_assert(((static_source_of<I, Ks, Edges...>() != multiple_sources) && ...),
+                  "An input is connected more than once");
+    // Only checked for inputs with a single source so the errors above aren't repeated here
+    static_assert(((static_source_of<I, Ks, Edges...>() >= multiple_sources || static_source_of<I, Ks, Edges...>() < I)
+                   && ...),
+                  "Nodes must be listed in topological order: edges can only point to later nodes");
+
+    template <std::size_t K>
+    using Source = StaticNodeTraits<std::tuple<Nodes...>, StaticEdges<Edges...>, static_source_of<I, K, Edges...>()>;
+
+    using Node   = std::tuple_element_t<I, std::tuple<Nodes...>>;
+    using Output = stored_output_t<std::invoke_result_t<Node&, typename Source<Ks>::Output const&...>>;
+};
+
+} // namespace detail
+
+template <typename Nodes, typename Edges>
+class StaticGraph;
+
+/**
+ * @brief A dataflow graph whose topology is fixed at compile time.
+ *
+ * Nodes are plain callables (each node's type is part of the graph's type) and the edges
+ * are a compile-time list, so a tick is a sequence of direct calls that the compiler can
+ * inline into straight-line code: no std::function, no virtual calls and no allocation.
+ * Nodes must be listed in topological order and every input must be connected once.
+ *
+ *     auto graph = ltb::ddf::make_static_graph<ltb::ddf::StaticEdges<ltb::ddf::StaticEdge<0, 2, 0>,
+ *                                                                    ltb::ddf::StaticEdge<1, 2, 1>,
+ *                                                                    ltb::ddf::StaticEdge<2, 3>>>(
+ *         read_sensor_a, read_sensor_b, [](float a, float b) { return a - b; }, publish);
+ *
+ *     graph.tick();
+ *     auto difference = graph.value<2>();
+ */
+template <typename... Nodes, typename... Edges>
+class StaticGraph<std::tuple<Nodes...>, StaticEdges<Edges...>> {
+    template <std::size_t I>
+    using Output = typename detail::StaticNodeTraits<std::tuple<Nodes...>, StaticEdges<Edges...>, I>::Output;
+
+public:
+    explicit StaticGraph(Nodes... nodes) : nodes_(std::move(nodes)...) {}
+
+    /// \brief Runs every node once in order
+    auto tick() -> void { tick(std::index_sequence_for<Nodes...>{}); }
+
+    /// \brief The output produced by node 'I' during the last tick
+    template <std::size_t I>
+    auto value() const -> Output<I> const& {
+        return std::get<I>(values_);
+    }
+
+    /// \brief Direct access to the callable for node 'I'
+    template <std::size_t I>
+    auto node() -> std::tuple_element_t<I, std::tuple<Nodes...>>& {
+        return std::get<I>(nodes_);
+    }
+
+private:
+    template <std::size_t... Is>
+    auto tick(std::index_sequence<Is...>) -> void {
+        (run<Is>(std::make_index_sequence<detail::static_input_count<Is, Edges...>()>{}), ...);
+    }
+
+    template <std::size_t I, std::size_t... Ks>
+    auto run(std::index_sequence<Ks...>) -> void {
+        auto& node = std::get<I>(nodes_);
+
+        if constexpr (std::is_same_v<Output<I>, NoOutput>) {
+            node(std::get<detail::static_source_of<I, Ks, Edges...>()>(values_)...);
+        } else {
+            std::get<I>(values_) = node(std::get<detail::static_source_of<I, Ks, Edges...>()>(values_)...);
+        }
+    }
+
+    template <std::size_t... Is>
+    static auto output_tuple(std::index_sequence<Is...>) -> std::tuple<Output<Is>...>;
+
+    std::tuple<Nodes...>                                        nodes_; ///< The callable for each node
+    decltype(output_tuple(std::index_sequence_for<Nodes...>{})) values_ = {}; ///< The output of each node
+};
+
+/// \brief Creates a StaticGraph from 'nodes' connected by 'Edges'
+template <typename Edges, typename... Nodes>
+auto make_static_graph(Nodes&&... nodes) -> StaticGraph<std::tuple<std::decay_t<Nodes>...>, Edges> {
+    return StaticGraph<std::tuple<std::decay_t<Nodes>...>, Edges>(std::forward<Nodes>(nodes)...);
+}
+
+namespace detail {
+
+template <std::size_t... Is>
+auto chain_edges(std::index_sequence<Is...>) -> StaticEdges<StaticEdge<Is, Is + 1u>...>;
+
+} // namespace detail
+
+/// \brief Creates a StaticGraph where each node feeds the next: nodes[0] -> nodes[1] -> ... -> nodes[N-1]
+template <typename... Nodes>
+auto make_static_pipeline(Nodes&&... nodes) {
+    using Edges = decltype(detail::chain_edges(std::make_index_sequence<sizeof...(Nodes) - 1u>{}));
+    return make_static_graph<Edges>(std::forward<Nodes>(nodes)...);
+}
+
+} // namespace ltb::ddf
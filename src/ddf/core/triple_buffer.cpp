@@ -0,0 +1,83 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "triple_buffer.hpp"
+
+// external
+#include <doctest/doctest.h>
+
+// standard
+#include <thread>
+
+TEST_CASE("[ltb][ddf] triple buffer") {
+    using namespace ltb;
+
+    ddf::TripleBuffer<int> buffer;
+    CHECK_FALSE(buffer.update());
+    CHECK(buffer.read() == 0);
+
+    buffer.write(1);
+    buffer.write(2);
+    CHECK(buffer.update());
+    CHECK(buffer.read() == 2);
+    CHECK_FALSE(buffer.update());
+    CHECK(buffer.read() == 2);
+
+    buffer.write_buffer() = 3;
+    CHECK_FALSE(buffer.update());
+    buffer.publish();
+    CHECK(buffer.update());
+    CHECK(buffer.read() == 3);
+}
+
+TEST_CASE("[ltb][ddf] triple buffer across threads") {
+    using namespace ltb;
+
+    struct Pair {
+        long first  = 0;
+        long second = 0;
+    };
+
+    constexpr auto count = 100000l;
+
+    ddf::TripleBuffer<Pair> buffer;
+
+    std::thread writer([&] {
+        for (auto i = 1l; i <= count; ++i) {
+            buffer.write(Pair{i, -i});
+        }
+    });
+
+    // The reader should never see a torn value or go backwards
+    auto consistent = true;
+    auto last       = 0l;
+    while (last < count) {
+        if (buffer.update()) {
+            auto const& pair = buffer.read();
+            consistent &= (pair.first == -pair.second) && (pair.first > last);
+            last = pair.first;
+        }
+    }
+    writer.join();
+
+    CHECK(consistent);
+}
@@ -0,0 +1,102 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "spsc_ring_buffer.hpp"
+
+// standard
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace ltb::ddf {
+
+/**
+ * @brief Lock-free "latest value" hand-off between one writer thread and one reader thread.
+ *
+ * The writer and reader each own one of three buffers and the third sits in the middle.
+ * Publishing swaps the writer's buffer into the middle and updating swaps the middle into
+ * the reader's hands, so neither side ever waits, allocates, or sees a partially written
+ * value. Intermediate values are dropped if the writer is faster than the reader.
+ *
+ *     ltb::ddf::TripleBuffer<Pose> pose;
+ *
+ *     // writer thread
+ *     pose.write(compute_pose());
+ *
+ *     // reader thread
+ *     if (pose.update()) { use(pose.read()); }
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    /// \brief Writer only. The buffer to fill before calling 'publish'.
+    auto write_buffer() -> T& { return buffers_[write_index_].value; }
+
+    /// \brief Writer only. Makes the write buffer the latest value.
+    auto publish() -> void {
+        auto const previous = middle_.exchange(static_cast<std::uint8_t>(write_index_ | fresh_bit),
+                                               std::memory_order_acq_rel);
+        write_index_        = static_cast<std::uint8_t>(previous & index_mask);
+    }
+
+    /// \brief Writer only. Equivalent to 'write_buffer() = value; publish();'
+    template <typename U>
+    auto write(U&& value) -> void {
+        write_buffer() = std::forward<U>(value);
+        publish();
+    }
+
+    /// \brief Reader only. Grabs the latest published value. Returns false if nothing new was published.
+    auto update() -> bool {
+        if ((middle_.load(std::memory_order_relaxed) & fresh_bit) == 0u) {
+            return false;
+        }
+        auto const previous = middle_.exchange(read_index_, std::memory_order_acq_rel);
+        read_index_         = static_cast<std::uint8_t>(previous & index_mask);
+        return true;
+    }
+
+    /// \brief Reader only. The value grabbed by the last successful 'update'.
+    auto read() const -> T const& { return buffers_[read_index_].value; }
+
+private:
+    static constexpr std::uint8_t index_mask = 0x3u;
+    static constexpr std::uint8_t fresh_bit  = 0x4u;
+
+    struct alignas(cache_line_size) Slot {
+        T value = {};
+    };
+
+    std::array<Slot, 3u> buffers_ = {};
+
+    alignas(cache_line_size) std::atomic<std::uint8_t> middle_{2u}; ///< Middle buffer index and fresh bit
+    alignas(cache_line_size) std::uint8_t write_index_ = 0u; ///< Only touched by the writer
+    alignas(cache_line_size) std::uint8_t read_index_  = 1u; ///< Only touched by the reader
+};
+
+} // namespace ltb::ddf
@@ -0,0 +1,72 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// LTB Dynamic Dataflow
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/util/type_string.hpp"
+
+// standard
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+namespace ltb::ddf {
+
+/**
+ * @brief The type-erased operations needed to store a port value in a compiled slot buffer.
+ *
+ * One instance exists per port type. Compiled graphs use these to lay out every output
+ * value in a single contiguous buffer without knowing the concrete types involved.
+ */
+struct TypeOps {
+    std::type_info const* type; ///< Used to check that connected ports have matching types
+    std::size_t           size; ///< sizeof(T)
+    std::size_t           alignment; ///< alignof(T)
+    void (*construct)(void* dst); ///< Default constructs a T at 'dst'
+    void (*destroy)(void* dst); ///< Destroys the T at 'dst'
+    std::string (*type_name)(); ///< Human readable type name used in error messages
+};
+
+template <typename T>
+auto type_ops() -> TypeOps const& {
+    static_assert(std::is_default_constructible_v<T>, "Port types must be default constructible");
+    static_assert(std::is_same_v<T, std::decay_t<T>>, "Port types must not be references or cv-qualified");
+
+    static TypeOps const ops = {
+        &typeid(T),
+        sizeof(T),
+        alignof(T),
+        [](void* dst) { ::new (dst) T(); },
+        [](void* dst) { static_cast<T*>(dst)->~T(); },
+        [] { return util::type_string<T>(); },
+    };
+    return ops;
+}
+
+inline auto same_type(TypeOps const& lhs, TypeOps const& rhs) -> bool {
+    return *lhs.type == *rhs.type;
+}
+
+} // namespace ltb::ddf
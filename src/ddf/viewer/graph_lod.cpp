@@ -0,0 +1,236 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "graph_lod.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+
+namespace ltb::ddf::vis {
+namespace {
+
+auto cell_coord(float value, float size) -> std::int32_t {
+    return static_cast<std::int32_t>(std::floor(value / size));
+}
+
+auto make_cell_key(std::int32_t x, std::int32_t y) -> std::uint64_t {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32u) | static_cast<std::uint32_t>(y);
+}
+
+auto cell_x(std::uint64_t key) -> std::int32_t {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32u));
+}
+
+auto cell_y(std::uint64_t key) -> std::int32_t {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(key));
+}
+
+auto contains(CanvasRect const& rect, ImVec2 const& point) -> bool {
+    return rect.min.x <= point.x && point.x <= rect.max.x && rect.min.y <= point.y && point.y <= rect.max.y;
+}
+
+} // namespace
+
+GraphLod::GraphLod(float cell_size, float cluster_size) : cell_size_(cell_size), cluster_size_(cluster_size) {}
+
+auto GraphLod::reset(GraphTopology const& topology, std::vector<ImVec2> positions) -> void {
+    positions_ = std::move(positions);
+    edges_     = topology.edges;
+
+    auto const node_count = positions_.size();
+
+    // Edges touching each node, in compressed rows so culling never allocates per node
+    incident_begin_.assign(node_count + 1u, 0u);
+    for (auto const& edge : edges_) {
+        ++incident_begin_[edge.from.node + 1u];
+        ++incident_begin_[edge.to.node + 1u];
+    }
+    for (auto n = 0u; n < node_count; ++n) {
+        incident_begin_[n + 1u] += incident_begin_[n];
+    }
+    incident_.resize(incident_begin_.back());
+    auto fill = std::vector<std::size_t>(incident_begin_.begin(), incident_begin_.end() - 1);
+    for (auto e = 0u; e < edges_.size(); ++e) {
+        incident_[fill[edges_[e].from.node]++] = e;
+        incident_[fill[edges_[e].to.node]++]   = e;
+    }
+
+    cells_.clear();
+    for (auto n = 0u; n < node_count; ++n) {
+        cells_[cell_key(positions_[n], cell_size_)].emplace_back(static_cast<NodeId>(n));
+    }
+
+    visible_stamp_.assign(node_count, 0u);
+    cull_count_ = 0u;
+    visible_nodes_.clear();
+    visible_edges_.clear();
+    clusters_dirty_ = true;
+}
+
+auto GraphLod::move_node(NodeId node, ImVec2 position) -> void {
+    auto const old_key = cell_key(positions_[node], cell_size_);
+    auto const new_key = cell_key(position, cell_size_);
+
+    if (old_key != new_key) {
+        auto& old_cell = cells_[old_key];
+        auto  iter     = std::find(old_cell.begin(), old_cell.end(), node);
+        *iter          = old_cell.back();
+        old_cell.pop_back();
+        if (old_cell.empty()) {
+            cells_.erase(old_key);
+        }
+        cells_[new_key].emplace_back(node);
+    }
+
+    if (cell_key(positions_[node], cluster_size_) != cell_key(position, cluster_size_)) {
+        clusters_dirty_ = true;
+    }
+    positions_[node] = position;
+}
+
+auto GraphLod::position(NodeId node) const -> ImVec2 {
+    return positions_[node];
+}
+
+auto GraphLod::node_count() const -> std::size_t {
+    return positions_.size();
+}
+
+auto GraphLod::cull(CanvasRect const& view) -> void {
+    if (++cull_count_ == 0u) {
+        // Wrapped around, so old stamps could look current
+        std::fill(visible_stamp_.begin(), visible_stamp_.end(), 0u);
+        cull_count_ = 1u;
+    }
+    visible_nodes_.clear();
+    visible_edges_.clear();
+
+    auto const min_x = cell_coord(view.min.x, cell_size_);
+    auto const min_y = cell_coord(view.min.y, cell_size_);
+    auto const max_x = cell_coord(view.max.x, cell_size_);
+    auto const max_y = cell_coord(view.max.y, cell_size_);
+
+    auto visit_cell = [&](std::vector<NodeId> const& cell) {
+        for (auto node : cell) {
+            if (contains(view, positions_[node])) {
+                mark_visible(node);
+            }
+        }
+    };
+
+    auto const cells_in_view = (static_cast<double>(max_x) - min_x + 1.0) * (static_cast<double>(max_y) - min_y + 1.0);
+    if (cells_in_view > static_cast<double>(cells_.size())) {
+        // Mostly empty space in view, so only look at the occupied cells
+        for (auto const& [key, cell] : cells_) {
+            if (min_x <= cell_x(key) && cell_x(key) <= max_x && min_y <= cell_y(key) && cell_y(key) <= max_y) {
+                visit_cell(cell);
+            }
+        }
+    } else {
+        for (auto x = min_x; x <= max_x; ++x) {
+            for (auto y = min_y; y <= max_y; ++y) {
+                auto iter = cells_.find(make_cell_key(x, y));
+                if (iter != cells_.end()) {
+                    visit_cell(iter->second);
+                }
+            }
+        }
+    }
+
+    // Keep links that leave the viewport attached to the node on the other end
+    auto const in_view = visible_nodes_.size();
+    for (auto i = 0u; i < in_view; ++i) {
+        auto const node = visible_nodes_[i];
+        for (auto j = incident_begin_[node]; j < incident_begin_[node + 1u]; ++j) {
+            auto const& edge = edges_[incident_[j]];
+            mark_visible(edge.from.node == node ? edge.to.node : edge.from.node);
+        }
+    }
+    std::sort(visible_nodes_.begin(), visible_nodes_.end());
+
+    for (auto node : visible_nodes_) {
+        for (auto j = incident_begin_[node]; j < incident_begin_[node + 1u]; ++j) {
+            auto const& edge = edges_[incident_[j]];
+            // Each edge is found from both ends so only keep it from its producer
+            if (edge.from.node == node && visible_stamp_[edge.to.node] == cull_count_) {
+                visible_edges_.emplace_back(incident_[j]);
+            }
+        }
+    }
+}
+
+auto GraphLod::visible_nodes() const -> std::vector<NodeId> const& {
+    return visible_nodes_;
+}
+
+auto GraphLod::visible_edges() const -> std::vector<std::size_t> const& {
+    return visible_edges_;
+}
+
+auto GraphLod::clusters() -> std::vector<NodeCluster> const& {
+    if (clusters_dirty_) {
+        build_clusters();
+    }
+    return clusters_;
+}
+
+auto GraphLod::cluster_edges() -> std::vector<ClusterEdge> const& {
+    if (clusters_dirty_) {
+        build_clusters();
+    }
+    return cluster_edges_;
+}
+
+auto GraphLod::cell_key(ImVec2 position, float size) const -> CellKey {
+    return make_cell_key(cell_coord(position.x, size), cell_coord(position.y, size));
+}
+
+auto GraphLod::mark_visible(NodeId node) -> void {
+    if (visible_stamp_[node] != cull_count_) {
+        visible_stamp_[node] = cull_count_;
+        visible_nodes_.emplace_back(node);
+    }
+}
+
+auto GraphLod::build_clusters() -> void {
+    clusters_.clear();
+    cluster_edges_.clear();
+
+    auto cluster_of = std::vector<std::uint32_t>(positions_.size());
+    auto lookup     = std::unordered_map<CellKey, std::uint32_t>{};
+
+    for (auto n = 0u; n < positions_.size(); ++n) {
+        auto [iter, inserted] = lookup.emplace(cell_key(positions_[n], cluster_size_), clusters_.size());
+        if (inserted) {
+            clusters_.emplace_back();
+        }
+        auto& cluster = clusters_[iter->second];
+        cluster.nodes.emplace_back(static_cast<NodeId>(n));
+        cluster.center.x += positions_[n].x;
+        cluster.center.y += positions_[n].y;
+        cluster_of[n] = iter->second;
+    }
+    for (auto& cluster : clusters_) {
+        cluster.center.x /= static_cast<float>(cluster.nodes.size());
+        cluster.center.y /= static_cast<float>(cluster.nodes.size());
+    }
+
+    auto edge_lookup = std::unordered_map<std::uint64_t, std::size_t>{};
+    for (auto const& edge : edges_) {
+        auto const from = cluster_of[edge.from.node];
+        auto const to   = cluster_of[edge.to.node];
+        if (from == to) {
+            continue;
+        }
+        auto [iter, inserted] = edge_lookup.emplace((static_cast<std::uint64_t>(from) << 32) | to,
+                                                    cluster_edges_.size());
+        if (inserted) {
+            cluster_edges_.push_back({from, to, 0u});
+        }
+        ++cluster_edges_[iter->second].count;
+    }
+    clusters_dirty_ = false;
+}
+
+} // namespace ltb::ddf::vis
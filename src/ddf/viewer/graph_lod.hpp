@@ -0,0 +1,104 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2020 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ddf/core/graph_metrics.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ltb::ddf::vis {
+
+/// \brief An axis aligned rectangle in node editor canvas coordinates
+struct CanvasRect {
+    ImVec2 min;
+    ImVec2 max;
+};
+
+/// \brief Nodes sharing one cell of the cluster grid, drawn as a single node when zoomed out
+struct NodeCluster {
+    std::vector<NodeId> nodes;
+    ImVec2              center; ///< Mean position of 'nodes'
+};
+
+/// \brief Every connection between two clusters, drawn as one link
+struct ClusterEdge {
+    std::uint32_t from;
+    std::uint32_t to;
+    std::uint32_t count; ///< The number of node connections represented
+};
+
+/**
+ * @brief Decides what GraphSubView submits each frame so huge graphs stay interactive.
+ *
+ * Node positions are cached here and bucketed into a uniform grid, so finding the nodes in
+ * the viewport only touches the grid cells it overlaps. The direct neighbours of visible
+ * nodes are included too so links leaving the viewport stay attached to something.
+ *
+ * The cached positions also group nodes into clusters on a coarser grid. When zoomed out
+ * too far to read individual nodes, each cluster is drawn as one aggregate node and all
+ * connections between two clusters as one link.
+ */
+class GraphLod {
+public:
+    /// \brief 'cell_size' is the side of a culling cell, 'cluster_size' the side of a cluster
+    explicit GraphLod(float cell_size = 1024.f, float cluster_size = 4096.f);
+
+    /// \brief Replaces the graph and its cached layout. 'positions' is indexed by NodeId.
+    auto reset(GraphTopology const& topology, std::vector<ImVec2> positions) -> void;
+
+    /// \brief Updates the cached position of a node (after the user dragged it, for example)
+    auto move_node(NodeId node, ImVec2 position) -> void;
+
+    auto position(NodeId node) const -> ImVec2;
+    auto node_count() const -> std::size_t;
+
+    /**
+     * @brief Finds the nodes whose top left corner lies in 'view' and their direct neighbours.
+     *
+     * The results (sorted by NodeId) and the edges between them are valid until the next call.
+     * Callers should grow 'view' by the size of the largest node so partially visible nodes
+     * are not culled.
+     */
+    auto cull(CanvasRect const& view) -> void;
+    auto visible_nodes() const -> std::vector<NodeId> const&;
+    auto visible_edges() const -> std::vector<std::size_t> const&; ///< Indices into GraphTopology::edges
+
+    /// \brief Clusters are rebuilt lazily after nodes move
+    auto clusters() -> std::vector<NodeCluster> const&;
+    auto cluster_edges() -> std::vector<ClusterEdge> const&;
+
+private:
+    using CellKey = std::uint64_t; ///< Packed signed cell coordinates
+
+    auto cell_key(ImVec2 position, float size) const -> CellKey;
+    auto mark_visible(NodeId node) -> void;
+    auto build_clusters() -> void;
+
+    float cell_size_;
+    float cluster_size_;
+
+    std::vector<ImVec2>                                positions_; ///< Indexed by NodeId
+    std::vector<GraphTopology::Edge>                   edges_;
+    std::vector<std::size_t>                           incident_begin_; ///< CSR offsets into 'incident_'
+    std::vector<std::size_t>                           incident_; ///< Edge indices touching each node
+    std::unordered_map<CellKey, std::vector<NodeId>>   cells_;
+
+    std::vector<std::uint32_t> visible_stamp_; ///< Equal to 'cull_count_' if visible this cull
+    std::uint32_t              cull_count_ = 0u;
+    std::vector<NodeId>        visible_nodes_;
+    std::vector<std::size_t>   visible_edges_;
+
+    bool                     clusters_dirty_ = true;
+    std::vector<NodeCluster> clusters_;
+    std::vector<ClusterEdge> cluster_edges_;
+};
+
+} // namespace ltb::ddf::vis
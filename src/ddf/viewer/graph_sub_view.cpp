@@ -6,7 +6,58 @@
 // project
 #include "ltb/util/generic_guard.hpp"
 
+// standard
+#include <algorithm>
+#include <cstdint>
+
 namespace ltb::ddf::vis {
+namespace {
+
+/// \brief Below this zoom nodes are drawn without their ports
+constexpr auto compact_zoom = 0.5f;
+/// \brief Below this zoom clusters of nodes are drawn as single nodes
+constexpr auto cluster_zoom = 0.15f;
+/// \brief Clusters whose center is this far outside the view are still drawn
+constexpr auto cluster_margin = 2048.f;
+
+/// \brief Set on every cluster id so they never collide with node ids
+constexpr auto cluster_bit = std::uintptr_t{1u} << (sizeof(std::uintptr_t) * 8u - 1u);
+
+auto node_id(NodeId node) -> ed::NodeId {
+    return ed::NodeId(static_cast<std::uintptr_t>(node) + 1u);
+}
+
+auto pin_id(PortRef const& port, ed::PinKind kind) -> ed::PinId {
+    // Unique across every node: [node + 1 | port | kind]
+    auto const node = static_cast<std::uintptr_t>(port.node) + 1u;
+    return ed::PinId((node << 17u) | (static_cast<std::uintptr_t>(port.index) << 1u)
+                     | (kind == ed::PinKind::Output ? 1u : 0u));
+}
+
+auto link_id(std::size_t edge) -> ed::LinkId {
+    return ed::LinkId(static_cast<std::uintptr_t>(edge) + 1u);
+}
+
+auto cluster_node_id(std::size_t cluster) -> ed::NodeId {
+    return ed::NodeId(cluster_bit | static_cast<std::uintptr_t>(cluster));
+}
+
+auto cluster_pin_id(std::size_t cluster, ed::PinKind kind) -> ed::PinId {
+    return ed::PinId(cluster_bit | (static_cast<std::uintptr_t>(cluster) << 1u)
+                     | (kind == ed::PinKind::Output ? 1u : 0u));
+}
+
+auto cluster_link_id(std::size_t edge) -> ed::LinkId {
+    return ed::LinkId(cluster_bit | static_cast<std::uintptr_t>(edge));
+}
+
+/// \brief Green (0) through yellow to red (1)
+auto heat_color(float heat, float alpha = 1.f) -> ImVec4 {
+    heat = std::clamp(heat, 0.f, 1.f);
+    return {std::min(1.f, 2.f * heat), std::min(1.f, 2.f * (1.f - heat)), 0.2f, alpha};
+}
+
+} // namespace
 
 GraphSubView::GraphSubView() {
     ed::Config config;
@@ -26,14 +77,46 @@ auto GraphSubView::configure_gui() -> void {
                                              [] { ed::SetCurrentEditor(nullptr); });
 
     // Start interaction with editor.
+    if (metrics_) {
+        metrics_->update();
+        update_heat();
+        display_channels();
+    }
+    update_layout();
+    if (layout_) {
+        ImGui::Text("Laying out graph (%zu crossings)...", layout_->latest().crossings);
+    }
+
+    // The editor fills the rest of the window
+    auto const screen_min  = ImGui::GetCursorScreenPos();
+    auto const screen_size = ImGui::GetContentRegionAvail();
+    auto const screen_max  = ImVec2{screen_min.x + screen_size.x, screen_min.y + screen_size.y};
+
     ed::Begin("Dataflow Graph Editor", ImVec2{0.0, 0.0f});
     {
-        // display_existing_nodes();
+        auto const view_min = ed::ScreenToCanvas(screen_min);
+        auto const view_max = ed::ScreenToCanvas(screen_max);
+        auto const zoom     = view_max.x > view_min.x ? (screen_max.x - screen_min.x) / (view_max.x - view_min.x) : 1.f;
+
+        // Nodes are culled by their top left corner so include any that could reach into view
+        auto const view = CanvasRect{{view_min.x - max_node_size_.x, view_min.y - max_node_size_.y}, view_max};
+
+        submitted_.clear();
+        // Nothing is drawn until the first layout arrives
+        if (metrics_ && lod_.node_count() == topology_.node_names.size()) {
+            if (zoom < cluster_zoom) {
+                display_clusters(view);
+            } else {
+                display_nodes(view, zoom < compact_zoom ? Detail::Compact : Detail::Full);
+            }
+        }
         // handle_interactions(cursor_top_left);
         // maybe_show_node_creation_popup();
     }
     ed::End();
 
+    sync_positions();
+
     ed::SetCurrentEditor(nullptr);
 }
 
@@ -41,4 +124,288 @@ auto GraphSubView::settings() const -> gvs::SubViewSettings {
     return {{100, 100}};
 }
 
+auto GraphSubView::watch(GraphTopology topology, std::shared_ptr<MetricsSampler> metrics) -> void {
+    // Watching the same graph again keeps its layout, including any nodes the user moved
+    auto const same_graph = topology.node_names == topology_.node_names
+        && (layout_ || lod_.node_count() == topology.node_names.size());
+
+    topology_      = std::move(topology);
+    metrics_       = std::move(metrics);
+    heat_sequence_ = 0u;
+    node_heat_.assign(topology_.node_names.size(), 0.f);
+    node_rate_.assign(topology_.node_names.size(), 0.f);
+
+    if (!same_graph) {
+        layout_nodes();
+    }
+}
+
+auto GraphSubView::update_heat() -> void {
+    auto const& metrics = metrics_->latest();
+
+    // A snapshot of a different graph (e.g. taken just after a hot swap) cannot be drawn
+    // on this topology, so any heat from an older snapshot is dropped with it
+    if (metrics.nodes.size() != topology_.node_names.size()) {
+        heat_sequence_ = 0u;
+        std::fill(node_heat_.begin(), node_heat_.end(), 0.f);
+        std::fill(node_rate_.begin(), node_rate_.end(), 0.f);
+        return;
+    }
+
+    // Only recomputed when a new snapshot arrives, not every frame
+    if (metrics.sequence == heat_sequence_) {
+        return;
+    }
+    heat_sequence_ = metrics.sequence;
+
+    auto max_share = 0.0;
+    auto max_rate  = 0.0;
+    for (auto const& node : metrics.nodes) {
+        max_share = std::max(max_share, node.share_of_tick);
+        max_rate  = std::max(max_rate, node.runs_per_second);
+    }
+    for (auto n = 0u; n < metrics.nodes.size(); ++n) {
+        node_heat_[n] = max_share > 0.0 ? static_cast<float>(metrics.nodes[n].share_of_tick / max_share) : 0.f;
+        node_rate_[n] = max_rate > 0.0 ? static_cast<float>(metrics.nodes[n].runs_per_second / max_rate) : 0.f;
+    }
+}
+
+auto GraphSubView::has_heat(GraphMetrics const& metrics) const -> bool {
+    return heat_sequence_ != 0u && metrics.nodes.size() == topology_.node_names.size();
+}
+
+auto GraphSubView::display_nodes(CanvasRect const& view, Detail detail) -> void {
+    auto const& metrics  = metrics_->latest();
+    auto const  has_data = has_heat(metrics);
+
+    lod_.cull(view);
+
+    for (auto const id : lod_.visible_nodes()) {
+        auto const heat = node_heat_[id];
+
+        ed::PushStyleColor(ed::StyleColor_NodeBorder, heat_color(heat));
+        ed::BeginNode(node_id(id));
+        {
+            ImGui::TextUnformatted(topology_.node_names[id].c_str());
+
+            if (detail == Detail::Compact) {
+                // Every link to this node attaches to the first port
+                auto const port = PortRef{id, 0u};
+                if (topology_.input_counts[id] > 0u) {
+                    ed::BeginPin(pin_id(port, ed::PinKind::Input), ed::PinKind::Input);
+                    ImGui::TextUnformatted(">");
+                    ed::EndPin();
+                    ImGui::SameLine();
+                }
+                if (topology_.output_counts[id] > 0u) {
+                    ed::BeginPin(pin_id(port, ed::PinKind::Output), ed::PinKind::Output);
+                    ImGui::TextUnformatted(">");
+                    ed::EndPin();
+                }
+            } else {
+                if (has_data) {
+                    ImGui::TextColored(heat_color(heat),
+                                       "%.3f ms  %.0f Hz",
+                                       metrics.nodes[id].mean_ns * 1e-6,
+                                       metrics.nodes[id].runs_per_second);
+                }
+
+                auto const rows = std::max(topology_.input_counts[id], topology_.output_counts[id]);
+                for (auto p = 0u; p < rows; ++p) {
+                    auto const port = PortRef{id, static_cast<PortIndex>(p)};
+
+                    if (p < topology_.input_counts[id]) {
+                        ed::BeginPin(pin_id(port, ed::PinKind::Input), ed::PinKind::Input);
+                        ImGui::Text("> in %u", p);
+                        ed::EndPin();
+                        ImGui::SameLine();
+                    }
+                    if (p < topology_.output_counts[id]) {
+                        ed::BeginPin(pin_id(port, ed::PinKind::Output), ed::PinKind::Output);
+                        ImGui::Text("out %u >", p);
+                        ed::EndPin();
+                    } else {
+                        ImGui::NewLine();
+                    }
+                }
+            }
+        }
+        ed::EndNode();
+        ed::PopStyleColor();
+
+        // The cached layout is applied lazily, so nodes that never come into view cost nothing
+        if (!placed_[id]) {
+            ed::SetNodePosition(node_id(id), lod_.position(id));
+            placed_[id] = true;
+        }
+        submitted_.emplace_back(id);
+    }
+
+    for (auto const e : lod_.visible_edges()) {
+        auto const& edge = topology_.edges[e];
+        auto const  rate = node_rate_[edge.from.node];
+
+        auto from = edge.from;
+        auto to   = edge.to;
+        if (detail == Detail::Compact) {
+            from.index = 0u;
+            to.index   = 0u;
+        }
+
+        ed::Link(link_id(e),
+                 pin_id(from, ed::PinKind::Output),
+                 pin_id(to, ed::PinKind::Input),
+                 ImVec4{0.3f + 0.7f * rate, 0.6f + 0.4f * rate, 1.f, 0.4f + 0.6f * rate},
+                 1.f + 3.f * rate);
+    }
+    was_clustered_ = false;
+}
+
+auto GraphSubView::display_clusters(CanvasRect const& view) -> void {
+    auto const& metrics  = metrics_->latest();
+    auto const  has_data = has_heat(metrics);
+    auto const& clusters = lod_.clusters();
+
+    // Clusters are small in number so a linear pass is cheap compared to drawing them
+    auto shown     = std::vector<bool>(clusters.size(), false);
+    auto share     = std::vector<double>(clusters.size(), 0.0);
+    auto max_share = 0.0;
+
+    auto const grown = CanvasRect{{view.min.x - cluster_margin, view.min.y - cluster_margin},
+                                  {view.max.x + cluster_margin, view.max.y + cluster_margin}};
+
+    for (auto c = 0u; c < clusters.size(); ++c) {
+        auto const& center = clusters[c].center;
+        shown[c] = grown.min.x <= center.x && center.x <= grown.max.x && grown.min.y <= center.y
+            && center.y <= grown.max.y;
+
+        if (has_data && shown[c]) {
+            for (auto const node : clusters[c].nodes) {
+                share[c] += metrics.nodes[node].share_of_tick;
+            }
+            max_share = std::max(max_share, share[c]);
+        }
+    }
+
+    for (auto c = 0u; c < clusters.size(); ++c) {
+        if (!shown[c]) {
+            continue;
+        }
+        auto const& cluster = clusters[c];
+        auto const  heat    = max_share > 0.0 ? static_cast<float>(share[c] / max_share) : 0.f;
+        auto const  hottest = *std::max_element(cluster.nodes.begin(), cluster.nodes.end(), [this](auto lhs, auto rhs) {
+            return node_heat_[lhs] < node_heat_[rhs];
+        });
+
+        ed::PushStyleColor(ed::StyleColor_NodeBorder, heat_color(heat));
+        ed::BeginNode(cluster_node_id(c));
+        {
+            ed::BeginPin(cluster_pin_id(c, ed::PinKind::Input), ed::PinKind::Input);
+            ImGui::Text("> %zu nodes", cluster.nodes.size());
+            ed::EndPin();
+            ImGui::SameLine();
+            ed::BeginPin(cluster_pin_id(c, ed::PinKind::Output), ed::PinKind::Output);
+            ImGui::TextUnformatted(">");
+            ed::EndPin();
+
+            if (has_data) {
+                ImGui::TextColored(heat_color(heat), "%.1f%% of tick", share[c] * 100.0);
+                ImGui::Text("hottest: %s", topology_.node_names[hottest].c_str());
+            }
+        }
+        ed::EndNode();
+        ed::PopStyleColor();
+
+        if (!was_clustered_) {
+            ed::SetNodePosition(cluster_node_id(c), cluster.center);
+        }
+    }
+
+    auto const& edges     = lod_.cluster_edges();
+    auto        max_count = 1u;
+    for (auto const& edge : edges) {
+        max_count = std::max(max_count, edge.count);
+    }
+    for (auto e = 0u; e < edges.size(); ++e) {
+        if (!shown[edges[e].from] || !shown[edges[e].to]) {
+            continue;
+        }
+        auto const weight = static_cast<float>(edges[e].count) / static_cast<float>(max_count);
+        ed::Link(cluster_link_id(e),
+                 cluster_pin_id(edges[e].from, ed::PinKind::Output),
+                 cluster_pin_id(edges[e].to, ed::PinKind::Input),
+                 ImVec4{0.6f, 0.8f, 1.f, 0.4f + 0.6f * weight},
+                 1.f + 5.f * weight);
+    }
+    was_clustered_ = true;
+}
+
+auto GraphSubView::display_channels() const -> void {
+    auto const& metrics = metrics_->latest();
+
+    if (metrics.sequence == 0u) {
+        ImGui::TextUnformatted("Waiting for metrics...");
+        return;
+    }
+    if (!profiling_enabled) {
+        ImGui::TextUnformatted("Profiling is disabled (build with LTB_DDF_ENABLE_PROFILING for live metrics)");
+    }
+
+    ImGui::Text("%.0f ticks/s  %.3f ms/tick", metrics.ticks_per_second, metrics.mean_tick_ns * 1e-6);
+
+    for (auto const& channel : metrics.channels) {
+        // A channel whose queue stays full is dropping events
+        auto const heat = channel.dropped > 0u ? 1.f : static_cast<float>(channel.mean_queue_depth / 64.0);
+        ImGui::SameLine();
+        ImGui::TextColored(heat_color(heat),
+                           "| %s: depth %.1f (max %llu, dropped %llu)",
+                           channel.name.c_str(),
+                           channel.mean_queue_depth,
+                           static_cast<unsigned long long>(channel.max_queue_depth),
+                           static_cast<unsigned long long>(channel.dropped));
+    }
+}
+
+auto GraphSubView::sync_positions() -> void {
+    // Pick up nodes the user dragged and the real node sizes for culling
+    for (auto const id : submitted_) {
+        auto const position = ed::GetNodePosition(node_id(id));
+        if (position.x != lod_.position(id).x || position.y != lod_.position(id).y) {
+            lod_.move_node(id, position);
+        }
+        auto const size  = ed::GetNodeSize(node_id(id));
+        max_node_size_.x = std::max(max_node_size_.x, size.x);
+        max_node_size_.y = std::max(max_node_size_.y, size.y);
+    }
+}
+
+auto GraphSubView::layout_nodes() -> void {
+    // Large graphs take a while to lay out so it runs in the background and each improvement
+    // is picked up by 'update_layout'
+    lod_ = GraphLod{};
+    placed_.clear();
+    layout_ = std::make_unique<LayoutJob>(topology_);
+}
+
+auto GraphSubView::update_layout() -> void {
+    if (!layout_ || !layout_->update()) {
+        return;
+    }
+    auto const& snapshot = layout_->latest();
+
+    auto positions = std::vector<ImVec2>(snapshot.positions.size());
+    std::transform(snapshot.positions.begin(), snapshot.positions.end(), positions.begin(), [](auto const& position) {
+        return ImVec2{position.x, position.y};
+    });
+
+    // Nodes move to the new layout as they come into view
+    lod_.reset(topology_, std::move(positions));
+    placed_.assign(topology_.node_names.size(), false);
+    was_clustered_ = false;
+
+    if (snapshot.finished) {
+        layout_ = nullptr;
+    }
+}
+
 } // namespace ltb::ddf::vis
@@ -4,6 +4,9 @@
 #pragma once
 
 // project
+#include "ddf/core/graph_layout.hpp"
+#include "ddf/core/graph_metrics.hpp"
+#include "graph_lod.hpp"
 #include "ltb/gvs/display/gui/sub_view.hpp"
 
 // external
@@ -12,12 +15,27 @@
 #include <imgui_node_editor.h>
 
 // standard
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace ed = ax::NodeEditor;
 
 namespace ltb::ddf::vis {
 
+/**
+ * @brief Draws a running ddf graph in a node editor canvas, colored by live metrics.
+ *
+ * Each node's border shows its share of the graph's execution time (green for idle through
+ * red for the hottest node) along with its mean execution time and rate. Each link is
+ * brighter and thicker the more often its producer runs. Metrics are read from a
+ * MetricsSampler once per frame, so drawing never waits on the thread ticking the graph.
+ *
+ * Only nodes near the viewport are submitted to the editor (see GraphLod). Zoomed out, nodes
+ * are drawn without their ports and further out each cluster of nodes is drawn as a single
+ * aggregate node. The graph is laid out in layers on a background thread (see LayoutJob);
+ * each improved layout is cached and applied to each node the first time it comes into view.
+ */
 class GraphSubView : public gvs::SubView {
 public:
     explicit GraphSubView();
@@ -28,8 +46,40 @@ public:
 
     auto settings() const -> gvs::SubViewSettings override;
 
+    /// \brief Displays 'topology', colored by the snapshots published to 'metrics'
+    auto watch(GraphTopology topology, std::shared_ptr<MetricsSampler> metrics) -> void;
+
 private:
+    enum class Detail {
+        Full, ///< Every port is drawn
+        Compact, ///< One input and one output pin per node
+        Clustered, ///< One aggregate node per cluster
+    };
+
+    auto update_heat() -> void;
+    auto has_heat(GraphMetrics const& metrics) const -> bool;
+    auto display_nodes(CanvasRect const& view, Detail detail) -> void;
+    auto display_clusters(CanvasRect const& view) -> void;
+    auto display_channels() const -> void;
+    auto sync_positions() -> void;
+    auto layout_nodes() -> void;
+    auto update_layout() -> void;
+
     std::shared_ptr<ed::EditorContext> node_context_;
+
+    GraphTopology                   topology_;
+    std::shared_ptr<MetricsSampler> metrics_;
+
+    std::unique_ptr<LayoutJob> layout_; ///< Null once the layout is finished
+    GraphLod                   lod_;
+    std::vector<bool>          placed_; ///< Indexed by NodeId, true once the cached layout was applied
+    std::vector<NodeId>        submitted_; ///< Nodes drawn this frame
+    ImVec2                     max_node_size_ = {200.f, 100.f}; ///< Grows the culling rect
+    bool                       was_clustered_ = false;
+
+    std::uint64_t      heat_sequence_ = 0u; ///< Metrics snapshot the heat below was computed from
+    std::vector<float> node_heat_; ///< Indexed by NodeId, share of tick relative to the hottest node
+    std::vector<float> node_rate_; ///< Indexed by NodeId, run rate relative to the most frequent node
 };
 
 } // namespace ltb::ddf::vis
@@ -26,6 +26,10 @@ MainWindow::MainWindow(const Arguments& arguments)
 
 MainWindow::~MainWindow() = default;
 
+auto MainWindow::watch(GraphTopology topology, std::shared_ptr<MetricsSampler> metrics) -> void {
+    graph_sub_view_.watch(std::move(topology), std::move(metrics));
+}
+
 auto MainWindow::update() -> void {}
 
 auto MainWindow::render(ltb::gvs::CameraPackage const& /*camera_package*/) const -> void {}
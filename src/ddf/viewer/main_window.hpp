@@ -4,9 +4,13 @@
 #pragma once
 
 // project
+#include "ddf/core/graph_metrics.hpp"
 #include "graph_sub_view.hpp"
 #include "ltb/gvs/display/gui/imgui_magnum_application.hpp"
 
+// standard
+#include <memory>
+
 namespace ltb::ddf::vis {
 
 class MainWindow : public gvs::ImGuiMagnumApplication {
@@ -14,6 +18,9 @@ public:
     explicit MainWindow(const Arguments& arguments);
     ~MainWindow() override;
 
+    /// \brief Displays 'topology' in the graph view, colored by the snapshots published to 'metrics'
+    auto watch(GraphTopology topology, std::shared_ptr<MetricsSampler> metrics) -> void;
+
 private:
     auto update() -> void final;
     auto render(gvs::CameraPackage const& camera_package) const -> void final;